@@ -40,7 +40,9 @@
 //   b cab
 //   b cabcab
 // hence the output string is: "bcc$aaabb"
+#pragma once
 #include <iostream>
+#include <utility>
 #include "../parlay/parallel.h"
 #include "../parlay/primitives.h"
 #include "../parlay/io.h"
@@ -51,12 +53,15 @@ using ucharseq = parlay::sequence<uchar>;
 
 // Int needs to be big enough to represent the lenght of s
 // Can be unsigned
+// Returns the transform along with the suffix array of the padded
+// string (so the character bwt[i] precedes the suffix at sa[i]), for
+// users that need both, e.g. an FM-index.
 template <class Int>
-ucharseq bw_encode(ucharseq const &s) {
+std::pair<ucharseq, parlay::sequence<Int>> bw_encode_with_sa(ucharseq const &s) {
   size_t n = s.size();
 
   // pad with a null at the start
-  auto ss = parlay::tabulate(n+1, [&] (size_t i) {
+  auto ss = parlay::tabulate(n+1, [&] (size_t i) -> uchar {
       return i == 0 ? 0 : s[i-1];});
 
   // Sort on suffixes
@@ -73,5 +78,29 @@ ucharseq bw_encode(ucharseq const &s) {
       return (j == 0) ? ss[n] : ss[j-1];});
   
   // std::cout << parlay::map(bwt,[] (uchar x) {return (char) x;}) << std::endl;
-  return bwt;
+  return std::make_pair(std::move(bwt), std::move(sa));
+}
+
+template <class Int>
+ucharseq bw_encode(ucharseq const &s) {
+  return bw_encode_with_sa<Int>(s).first;
+}
+
+// The transform as usually described, for strings that can contain
+// nulls (e.g. blocks of a binary file): s is followed by an end marker
+// smaller than all characters, and the marker is left out of the
+// result.  Returns the n characters and the row the marker was at,
+// which the inverse needs.
+template <class Int>
+std::pair<ucharseq, size_t> bw_encode_with_end(ucharseq const &s) {
+  size_t n = s.size();
+  if (n == 0) return std::make_pair(ucharseq(), (size_t) 0);
+
+  // row 0 is the empty suffix, and row i+1 the suffix at sa[i]
+  auto sa = suffix_array<Int>(s);
+  size_t marker = 1 + (parlay::find(sa, (Int) 0) - sa.begin());
+  auto bwt = parlay::tabulate(n, [&] (size_t i) -> uchar {
+      size_t row = (i < marker) ? i : i + 1;
+      return (row == 0) ? s[n-1] : s[(size_t) sa[row-1] - 1];});
+  return std::make_pair(std::move(bwt), marker);
 }
@@ -0,0 +1,102 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Tokenizing and grouping of documents for inverted indices, shared by
+// the invertedIndex, indexQuery and indexUpdate benchmarks so that they
+// all index text the same way.  The words of a document are the
+// maximal runs of letters, in lower case.
+//
+// Supports the following interface:
+//
+//   // each distinct word of the documents, in sorted order, with the
+//   // sorted ids of the documents it appears in, where docs[j] is the
+//   // text of document first_id + j
+//   template <class Docs> parlay::sequence<word_docs>
+//   group_document_words(Docs const &docs, uint32_t first_id = 0);
+//
+//   // the documents of s: the parts that begin with doc_start (which
+//   // is not part of them), as slices of s
+//   template <class Seq> auto split_documents(Seq const &s, Seq const &doc_start);
+//
+//   // the compressed index of the documents of s
+//   template <class Seq> posting_lists build_posting_lists(Seq const &s, Seq const &doc_start);
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include "../parlay/primitives.h"
+#include "../parlay/sequence.h"
+#include "../parlay/internal/group_by.h"
+#include "string_search.h"
+#include "posting_lists.h"
+
+namespace pbbs {
+
+  using word_docs = std::pair<parlay::sequence<char>, parlay::sequence<uint32_t>>;
+
+  template <class Docs>
+  parlay::sequence<word_docs> group_document_words(Docs const &docs, uint32_t first_id = 0) {
+    // the distinct words of each document, tagged with its id
+    auto tokens = parlay::tabulate(docs.size(), [&] (size_t j) {
+      uint32_t doc_id = first_id + j;
+      // blank out all non letters, and convert to lowercase
+      auto str = parlay::map(docs[j], [] (char c) -> char {
+	  if (c >= 65 && c < 91) return c + 32;   // upper to lower
+	  else if (c >= 97 && c < 123) return c;  // already lower
+	  else return 0;});                       // all other
+      auto words = parlay::remove_duplicates(parlay::tokens(str, [] (char c) {
+	    return c == 0;}));
+      return parlay::map(words, [&] (auto const &w) {return std::pair(w, doc_id);});
+    });
+
+    // group by word, and sort the words and each of their lists
+    auto words = parlay::group_by_key(parlay::flatten(std::move(tokens)));
+    parlay::sort_inplace(words, [] (word_docs const &a, word_docs const &b) {
+	return a.first < b.first;});
+    parlay::parallel_for(0, words.size(), [&] (size_t i) {
+      parlay::sort_inplace(words[i].second);});
+    return words;
+  }
+
+  template <class Seq>
+  auto split_documents(Seq const &s, Seq const &doc_start) {
+    size_t n = s.size();
+    size_t m = doc_start.size();
+    auto starts = find_all(s, doc_start);
+    size_t num_docs = starts.size();
+    return parlay::tabulate(num_docs, [&] (size_t j) {
+	size_t end = (j + 1 == num_docs) ? n : starts[j+1];
+	return s.cut(starts[j] + m, end);});
+  }
+
+  template <class Seq>
+  posting_lists build_posting_lists(Seq const &s, Seq const &doc_start) {
+    auto words = group_document_words(split_documents(s, doc_start));
+    auto word_strs = parlay::delayed_map(words, [] (word_docs const &w) {
+	return std::string_view(w.first.data(), w.first.size());});
+    auto doc_lists = parlay::delayed_map(words, [] (word_docs const &w) {
+	return parlay::make_slice(w.second);});
+    return posting_lists(word_strs, doc_lists);
+  }
+}
@@ -0,0 +1,91 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Euler tours of the trees of a forest, and rooting the forest with them.
+//
+// The forest has vertices [0,n) and is given by an edge list, with no
+// edge given twice.  Edge e = (u,v) gives two arcs, 2e for u->v and 2e+1
+// for v->u.  The arcs out of each vertex are put in a fixed cyclic
+// order, and the arc after u->v in the tour is the one after v->u around
+// v.  This links the arcs of each tree into a cycle, which is ranked
+// with list_rank.  The cycle is ranked from an arbitrary arc, and the
+// source of that arc is taken as the root of the tree.  An arc u->v then
+// goes down the tree if it comes before v->u in the tour.
+//
+// Supports the following interface:
+//
+//   // the position of each arc in the Euler tour of its tree
+//   template <class Int> parlay::sequence<Int>
+//   euler_tour(parlay::sequence<std::pair<Int,Int>> const &edges);
+//
+//   // the parent of each vertex when each tree is rooted at some vertex,
+//   // with roots (including isolated vertices) their own parent
+//   template <class Int> parlay::sequence<Int>
+//   root_forest(size_t n, parlay::sequence<std::pair<Int,Int>> const &edges);
+
+#pragma once
+#include <utility>
+#include "../parlay/parallel.h"
+#include "../parlay/primitives.h"
+#include "../parlay/sequence.h"
+#include "list_rank.h"
+
+namespace pbbs {
+
+  template <class Int>
+  parlay::sequence<Int>
+  euler_tour(parlay::sequence<std::pair<Int,Int>> const &edges) {
+    size_t m = 2 * edges.size();
+    auto source = [&] (size_t a) -> Int {
+      return (a & 1) ? edges[a/2].second : edges[a/2].first;};
+
+    // arcs grouped by source, and the start of the group of each arc
+    auto arcs = parlay::integer_sort(parlay::tabulate(m, [] (size_t a) {return (Int) a;}),
+				     [&] (Int a) {return source(a);});
+    auto group_start = parlay::tabulate(m, [&] (size_t i) -> Int {
+	return (i == 0 || source(arcs[i]) != source(arcs[i-1])) ? i : 0;});
+    parlay::scan_inclusive_inplace(group_start, parlay::maxm<Int>());
+
+    // the arc after each one around its source, indexed by arc
+    auto around = parlay::sequence<Int>::uninitialized(m);
+    parlay::parallel_for(0, m, [&] (size_t i) {
+	bool last = (i + 1 == m || source(arcs[i+1]) != source(arcs[i]));
+	around[arcs[i]] = last ? arcs[group_start[i]] : arcs[i+1];});
+
+    auto next = parlay::delayed_tabulate(m, [&] (size_t a) {
+	return around[a ^ 1];});
+    return list_rank(next);
+  }
+
+  template <class Int>
+  parlay::sequence<Int>
+  root_forest(size_t n, parlay::sequence<std::pair<Int,Int>> const &edges) {
+    auto rank = euler_tour(edges);
+    auto parent = parlay::tabulate(n, [] (size_t v) {return (Int) v;});
+    // each non-root vertex has one arc coming down into it
+    parlay::parallel_for(0, edges.size(), [&] (size_t e) {
+	auto [u, v] = edges[e];
+	if (rank[2*e] < rank[2*e+1]) parent[v] = u;
+	else parent[u] = v;});
+    return parent;
+  }
+}
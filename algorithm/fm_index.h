@@ -0,0 +1,147 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// An FM-index (Ferragina and Manzini, "Opportunistic data structures
+// with applications", 2000) for counting and locating the occurrences
+// of patterns in a text.
+//
+// It is built from the Burrows-Wheeler transform of the text given by
+// bw_encode_with_sa (see bw_encode.h), with the characters renumbered
+// densely and stored in a wavelet matrix (see wavelet_matrix.h), so a
+// rank takes one cache line per bit of the alphabet.  Counting a
+// pattern of length m takes m steps of backward search.  The suffix
+// array is kept for the text positions that are multiples of
+// sample_rate, with a bit vector marking their rows, and locating an
+// occurrence walks back at most sample_rate - 1 characters to a sampled
+// one.  The text must not contain null characters.
+//
+//   fm_index<indexT> F(s, sample_rate);  // s a sequence<unsigned char>
+//   F.size()                 // length of the text
+//   F.count(P)               // number of occurrences of pattern P
+//   F.locate(P, k)           // positions of up to k of them, in suffix order
+//   F.size_in_bytes()        // bytes of the whole index
+//
+// indexT holds the sampled positions and needs to hold n, e.g. unsigned
+// int below 2^32 characters or pbbs::uint40 above.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "../parlay/parallel.h"
+#include "../parlay/primitives.h"
+#include "bw_encode.h"
+#include "wavelet_matrix.h"
+
+namespace pbbs {
+
+  template <class indexT>
+  class fm_index {
+    static constexpr uint16_t absent = 256;
+    size_t n = 0;
+    size_t sample_rate;
+    std::array<uint16_t,256> code;   // dense code of each character (0 for null)
+    parlay::sequence<size_t> C;      // rows starting with a code less than c
+    wavelet_matrix bwt;
+    rank_bitvector sampled;          // rows whose text position is sampled
+    parlay::sequence<indexT> samples;
+
+    // the row of the suffix one character earlier in the text than row i
+    size_t LF(size_t i) const {
+      auto [c, r] = bwt.inverse_select(i);
+      return C[c] + r;
+    }
+
+    size_t text_position(size_t i) const {
+      size_t steps = 0;
+      while (!sampled[i]) {i = LF(i); steps++;}
+      return (size_t) samples[sampled.rank1(i)] + steps;
+    }
+
+  public:
+    fm_index(parlay::sequence<unsigned char> const &s, size_t sample_rate = 32)
+      : n(s.size()), sample_rate(sample_rate) {
+      auto encoded = bw_encode_with_sa<indexT>(s);
+      auto &L = encoded.first;
+      auto &sa = encoded.second;
+
+      // renumber the characters densely, with the null character as 0
+      auto counts = parlay::histogram_by_index(L, 256);
+      size_t sigma = 0;
+      for (size_t c = 0; c < 256; c++)
+	code[c] = (c == 0 || counts[c] > 0) ? sigma++ : absent;
+      C = parlay::sequence<size_t>(sigma + 1, 0);
+      for (size_t c = 0; c < 256; c++)
+	if (code[c] != absent) C[code[c] + 1] = counts[c];
+      parlay::scan_inclusive_inplace(C, parlay::addm<size_t>());
+      auto codes = parlay::map(L, [&] (unsigned char c) -> uint8_t {return code[c];});
+      L.clear();
+      bwt = wavelet_matrix(codes, std::max<size_t>(1, parlay::log2_up(sigma)));
+      codes.clear();
+
+      // row i is the suffix at sa[i]-1 of the text with a null at the
+      // end, and row 0 (sa[i] = 0) is the null alone, at n
+      auto position = [&] (size_t i) -> size_t {
+	return (sa[i] == 0) ? n : (size_t) sa[i] - 1;};
+      auto is_sample = [&] (size_t i) {return position(i) % sample_rate == 0;};
+      sampled = rank_bitvector(n + 1, is_sample);
+      samples = parlay::map(parlay::pack_index(parlay::delayed_seq<bool>(n + 1, is_sample)),
+			    [&] (size_t i) -> indexT {return position(i);});
+    }
+
+    size_t size() const {return n;}
+
+    // the rows [sp, ep) of the suffixes starting with P
+    template <class Pattern>
+    std::pair<size_t,size_t> range(Pattern const &P) const {
+      size_t sp = 0, ep = n + 1;
+      for (size_t k = P.size(); k > 0 && sp < ep; k--) {
+	uint16_t c = code[(unsigned char) P[k-1]];
+	if (c == absent || c == 0) return std::make_pair(0, 0);
+	auto [rs, re] = bwt.rank(c, sp, ep);
+	sp = C[c] + rs;
+	ep = C[c] + re;
+      }
+      return std::make_pair(sp, std::max(sp, ep));
+    }
+
+    template <class Pattern>
+    size_t count(Pattern const &P) const {
+      auto [sp, ep] = range(P);
+      return ep - sp;
+    }
+
+    template <class Pattern>
+    parlay::sequence<size_t> locate(Pattern const &P, size_t max_results) const {
+      auto [sp, ep] = range(P);
+      size_t m = std::min(ep - sp, max_results);
+      return parlay::tabulate(m, [&] (size_t k) {return text_position(sp + k);}, 1);
+    }
+
+    size_t size_in_bytes() const {
+      return (sizeof(*this) + C.size() * sizeof(size_t) + bwt.size_in_bytes() +
+	      sampled.size_in_bytes() + samples.size() * sizeof(indexT));
+    }
+  };
+}
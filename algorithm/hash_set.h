@@ -0,0 +1,164 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <iostream>
+#include <type_traits>
+#include "../parlay/parallel.h"
+#include "../parlay/primitives.h"
+#include "../common/atomics.h"
+
+// A concurrent hash set over the elements of an array, for duplicate
+// removal and similar kernels.  Supports the following interface:
+//
+//   // set of positions of A, with room for capacity distinct elements
+//   // (rounded up to a power of two)
+//   index_hash_set<Seq,Hash,Equal> S(A, capacity, hash, equal);
+//   S.insert(i)    // adds position i unless an equal element is in the
+//                  // set, returns true if it was added, safe to call in
+//                  // parallel
+//   S.find_or_insert(i)  // as insert, but returns the position in the set
+//                        // that is equal to A[i] (i itself if it was added)
+//   S.find(x)      // the position in the set that is equal to x, or
+//                  // S.not_found, safe to call in parallel with find
+//   S.entries()    // the positions in the set, in table order
+//
+//   // 64-bit hash for integers and contiguous ranges of characters
+//   uint64_t hash_value(T const &x);
+//   uint64_t hash_bytes(char const* s, size_t len);
+//
+// The table does not grow, so it is best sized from estimate_distinct
+// in hyperloglog.h.
+
+namespace pbbs {
+
+  // reads eight bytes at a time
+  inline uint64_t hash_bytes(char const* s, size_t len) {
+    uint64_t h = len;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+      uint64_t w;
+      std::memcpy(&w, s + i, 8);
+      h = (h ^ w) * 0x9e3779b97f4a7c15ul;
+      h ^= h >> 29;
+    }
+    if (i < len) {
+      uint64_t w = 0;
+      std::memcpy(&w, s + i, len - i);
+      h = (h ^ w) * 0x9e3779b97f4a7c15ul;
+    }
+    return parlay::hash64(h);
+  }
+
+  template <class T>
+  uint64_t hash_value(T const &x) {
+    if constexpr (std::is_integral<T>::value) return parlay::hash64((uint64_t) x);
+    else return hash_bytes((char const*) x.data(), x.size());
+  }
+
+  // Open addressing with linear probing.  A probe starts at the first slot
+  // of a cache line, so the first eight slots it reads cost one miss.  A
+  // slot holds the top 24 bits of the hash above the position plus one
+  // (0 is empty), so most mismatches are rejected without reading A.
+  // An insert claims an empty slot with a compare-and-swap, and if that
+  // fails rereads the slot, since the winner may hold an equal element.
+  // The table does not grow: callers should size it from an estimate of
+  // the distinct count and keep it at most about 3/4 full.
+  template <class Seq, class Hash, class Equal>
+  class index_hash_set {
+    static constexpr size_t line_slots = 64 / sizeof(uint64_t);
+    static constexpr int index_bits = 40;
+    static constexpr uint64_t index_mask = (((uint64_t) 1) << index_bits) - 1;
+
+    Seq const &A;
+    Hash hash;
+    Equal equal;
+    size_t num_lines;
+    parlay::sequence<uint64_t> storage;
+    uint64_t* table;  // storage aligned to a cache line
+
+  public:
+    index_hash_set(Seq const &A, size_t capacity, Hash hash, Equal equal)
+      : A(A), hash(hash), equal(equal) {
+      size_t size = line_slots;
+      while (size < capacity) size *= 2;
+      num_lines = size / line_slots;
+      storage = parlay::sequence<uint64_t>(size + line_slots, (uint64_t) 0);
+      uintptr_t addr = (uintptr_t) storage.begin();
+      table = (uint64_t*) ((addr + 63) & ~((uintptr_t) 63));
+    }
+
+    static constexpr size_t not_found = ~((size_t) 0);
+
+    size_t capacity() const {return num_lines * line_slots;}
+
+    bool insert(size_t i) {return find_or_insert(i) == i;}
+
+    size_t find_or_insert(size_t i) {
+      uint64_t h = hash(A[i]);
+      uint64_t tag = h >> index_bits;
+      uint64_t entry = (tag << index_bits) | (i + 1);
+      size_t size = capacity();
+      size_t pos = (h & (num_lines - 1)) * line_slots;
+      for (size_t probes = 0; probes < size; probes++) {
+	uint64_t v = table[pos];
+	if (v == 0) {
+	  if (atomic_compare_and_swap(&table[pos], (uint64_t) 0, entry)) return i;
+	  v = table[pos];
+	}
+	if ((v >> index_bits) == tag && equal(A[(v & index_mask) - 1], A[i]))
+	  return (v & index_mask) - 1;
+	pos = (pos + 1 == size) ? 0 : pos + 1;
+      }
+      std::cout << "index_hash_set: table full" << std::endl;
+      abort();
+    }
+
+    template <class T>
+    size_t find(T const &x) const {
+      uint64_t h = hash(x);
+      uint64_t tag = h >> index_bits;
+      size_t size = capacity();
+      size_t pos = (h & (num_lines - 1)) * line_slots;
+      for (size_t probes = 0; probes < size; probes++) {
+	uint64_t v = table[pos];
+	if (v == 0) return not_found;
+	if ((v >> index_bits) == tag && equal(A[(v & index_mask) - 1], x))
+	  return (v & index_mask) - 1;
+	pos = (pos + 1 == size) ? 0 : pos + 1;
+      }
+      return not_found;
+    }
+
+    parlay::sequence<size_t> entries() const {
+      auto slots = parlay::make_slice(table, table + capacity());
+      auto used = parlay::filter(slots, [] (uint64_t v) {return v != 0;});
+      return parlay::map(used, [] (uint64_t v) -> size_t {
+	  return (v & index_mask) - 1;});
+    }
+  };
+}
@@ -0,0 +1,232 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Canonical Huffman coding of sequences of small integer symbols, with
+// code lengths limited so that decoding can use a table.
+//
+// The symbols are coded in chunks of a fixed number of symbols, each
+// starting on a byte boundary, so that chunks are encoded and decoded
+// in parallel.  The caller keeps the end of each chunk, as returned by
+// the encoder, next to the bytes.  Codes are written most significant
+// bit first.  Decoding looks up the next table_bits bits in a table,
+// and only codes longer than that are decoded a bit at a time.
+//
+// Supports the following interface:
+//
+//   // code lengths (0 for symbols that do not appear) of an optimal
+//   // code for the given counts with no code longer than max_length
+//   // (for as many symbols as there are counts, at most 2^max_length)
+//   parlay::sequence<uint8_t> huffman_lengths(parlay::sequence<size_t> const &counts,
+//                                             int max_length = huffman_max_length);
+//
+//   // the bytes of symbols[0,n) coded with the canonical code with the
+//   // given lengths, and the end of each chunk of chunk_size symbols
+//   template <class Seq>
+//   std::pair<parlay::sequence<uint8_t>, parlay::sequence<size_t>>
+//   huffman_encode(Seq const &symbols, parlay::sequence<uint8_t> const &lengths,
+//                  size_t chunk_size);
+//
+//   // decodes n symbols from the bytes of the chunks ending at chunk_ends
+//   template <class Sym>
+//   parlay::sequence<Sym> huffman_decode(uint8_t const* bytes, parlay::sequence<size_t> const &chunk_ends,
+//                                        size_t n, parlay::sequence<uint8_t> const &lengths,
+//                                        size_t chunk_size);
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "../parlay/primitives.h"
+#include "../parlay/sequence.h"
+
+namespace pbbs {
+
+  constexpr int huffman_max_length = 20;
+
+  namespace huffman_internal {
+
+    // lengths of an unrestricted Huffman code, by the two queue method on
+    // the symbols sorted by count
+    inline std::vector<int> unlimited_lengths(std::vector<size_t> const &counts) {
+      size_t m = counts.size();
+      std::vector<size_t> order;
+      for (size_t i = 0; i < m; i++) if (counts[i] > 0) order.push_back(i);
+      std::vector<int> lengths(m, 0);
+      if (order.size() == 1) lengths[order[0]] = 1;
+      if (order.size() <= 1) return lengths;
+      std::sort(order.begin(), order.end(), [&] (size_t a, size_t b) {
+	  return counts[a] < counts[b];});
+
+      // nodes 0..k-1 are leaves in order, k.. are internal in creation order
+      size_t k = order.size();
+      std::vector<size_t> weight(2*k - 1), parent(2*k - 1);
+      for (size_t i = 0; i < k; i++) weight[i] = counts[order[i]];
+      size_t leaf = 0, internal = k;
+      auto take = [&] (size_t next) {
+	if (leaf < k && (internal == next || weight[leaf] <= weight[internal]))
+	  return leaf++;
+	return internal++;
+      };
+      for (size_t next = k; next < 2*k - 1; next++) {
+	size_t a = take(next), b = take(next);
+	weight[next] = weight[a] + weight[b];
+	parent[a] = parent[b] = next;
+      }
+      std::vector<int> depth(2*k - 1, 0);
+      for (size_t i = 2*k - 2; i-- > 0;) depth[i] = depth[parent[i]] + 1;
+      for (size_t i = 0; i < k; i++) lengths[order[i]] = depth[i];
+      return lengths;
+    }
+
+    // the canonical code: symbols of the same length get consecutive
+    // codes in order of symbol, and shorter codes come first
+    struct canonical {
+      int max_length = 0;
+      std::vector<uint32_t> codes;
+      std::vector<uint32_t> first_code, count, first_index;
+      std::vector<uint32_t> sorted;  // the symbols by length, then symbol
+
+      canonical(parlay::sequence<uint8_t> const &lengths) : codes(lengths.size(), 0) {
+	for (auto l : lengths) max_length = std::max<int>(max_length, l);
+	first_code.assign(max_length + 2, 0);
+	count.assign(max_length + 2, 0);
+	first_index.assign(max_length + 2, 0);
+	for (auto l : lengths) if (l > 0) count[l]++;
+	uint32_t code = 0, index = 0;
+	for (int l = 1; l <= max_length; l++) {
+	  first_code[l] = code;
+	  first_index[l] = index;
+	  code = (code + count[l]) << 1;
+	  index += count[l];
+	}
+	sorted.resize(index);
+	std::vector<uint32_t> next(first_code), next_index(first_index);
+	for (size_t s = 0; s < lengths.size(); s++)
+	  if (lengths[s] > 0) {
+	    codes[s] = next[lengths[s]]++;
+	    sorted[next_index[lengths[s]]++] = s;
+	  }
+      }
+    };
+
+    constexpr int table_bits = 11;
+  }
+
+  inline parlay::sequence<uint8_t> huffman_lengths(parlay::sequence<size_t> const &counts,
+						   int max_length = huffman_max_length) {
+    using namespace huffman_internal;
+    std::vector<size_t> c(counts.begin(), counts.end());
+    while (true) {
+      std::vector<int> lengths = unlimited_lengths(c);
+      if (*std::max_element(lengths.begin(), lengths.end()) <= max_length)
+	return parlay::tabulate(lengths.size(), [&] (size_t i) {
+	    return (uint8_t) lengths[i];});
+      // flatten the counts and try again, as bzip2 does
+      for (auto &x : c) if (x > 0) x = 1 + x / 2;
+    }
+  }
+
+  template <class Seq>
+  std::pair<parlay::sequence<uint8_t>, parlay::sequence<size_t>>
+  huffman_encode(Seq const &symbols, parlay::sequence<uint8_t> const &lengths,
+		 size_t chunk_size) {
+    huffman_internal::canonical code(lengths);
+    size_t n = symbols.size();
+    size_t num_chunks = (n + chunk_size - 1) / chunk_size;
+    auto chunk_ends = parlay::tabulate(num_chunks, [&] (size_t c) {
+	size_t bits = 0;
+	for (size_t i = c * chunk_size; i < std::min(n, (c+1) * chunk_size); i++)
+	  bits += lengths[symbols[i]];
+	return (bits + 7) / 8;}, 1);
+    size_t total = parlay::reduce(chunk_ends);
+    parlay::scan_inclusive_inplace(chunk_ends);
+    auto bytes = parlay::sequence<uint8_t>::uninitialized(total);
+    parlay::parallel_for(0, num_chunks, [&] (size_t c) {
+	uint8_t* out = bytes.begin() + ((c == 0) ? 0 : chunk_ends[c-1]);
+	uint64_t acc = 0;
+	int bits = 0;
+	for (size_t i = c * chunk_size; i < std::min(n, (c+1) * chunk_size); i++) {
+	  acc = (acc << lengths[symbols[i]]) | code.codes[symbols[i]];
+	  bits += lengths[symbols[i]];
+	  while (bits >= 8) {
+	    bits -= 8;
+	    *out++ = (uint8_t) (acc >> bits);
+	  }
+	}
+	if (bits > 0) *out = (uint8_t) (acc << (8 - bits));
+      }, 1);
+    return std::make_pair(std::move(bytes), std::move(chunk_ends));
+  }
+
+  template <class Sym>
+  parlay::sequence<Sym> huffman_decode(uint8_t const* bytes,
+				       parlay::sequence<size_t> const &chunk_ends,
+				       size_t n, parlay::sequence<uint8_t> const &lengths,
+				       size_t chunk_size) {
+    using huffman_internal::table_bits;
+    huffman_internal::canonical code(lengths);
+
+    // entry for each table_bits prefix: (symbol << 8) | length, with
+    // length 0 for prefixes of longer codes
+    std::vector<uint32_t> table(1 << table_bits, 0);
+    for (size_t s = 0; s < lengths.size(); s++) {
+      int l = lengths[s];
+      if (l > 0 && l <= table_bits) {
+	uint32_t first = code.codes[s] << (table_bits - l);
+	for (uint32_t j = 0; j < (1u << (table_bits - l)); j++)
+	  table[first + j] = (s << 8) | l;
+      }
+    }
+
+    auto out = parlay::sequence<Sym>::uninitialized(n);
+    parlay::parallel_for(0, chunk_ends.size(), [&] (size_t c) {
+	uint8_t const* in = bytes + ((c == 0) ? 0 : chunk_ends[c-1]);
+	uint8_t const* end = bytes + chunk_ends[c];
+	// the next bits are at the top of acc, and past the end are zeros
+	uint64_t acc = 0;
+	int bits = 0;
+	for (size_t i = c * chunk_size; i < std::min(n, (c+1) * chunk_size); i++) {
+	  while (bits <= 56) {
+	    if (in < end) acc |= ((uint64_t) *in++) << (56 - bits);
+	    bits += 8;
+	  }
+	  uint32_t e = table[acc >> (64 - table_bits)];
+	  int l = e & 255;
+	  uint32_t s;
+	  if (l > 0) s = e >> 8;
+	  else {
+	    l = table_bits + 1;
+	    while (l < code.max_length &&
+		   (acc >> (64 - l)) - code.first_code[l] >= code.count[l]) l++;
+	    s = code.sorted[code.first_index[l] + (acc >> (64 - l)) - code.first_code[l]];
+	  }
+	  out[i] = (Sym) s;
+	  acc <<= l;
+	  bits -= l;
+	}
+      }, 1);
+    return out;
+  }
+}
@@ -0,0 +1,109 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "../parlay/parallel.h"
+#include "../parlay/primitives.h"
+
+// HyperLogLog sketches (Flajolet, Fusy, Gandouet and Meunier, 2007) for
+// estimating the number of distinct keys, e.g. to size hash tables.
+// With 2^p registers the standard error is about 1.04/sqrt(2^p), so
+// 1.6% for the default p = 12, which takes 4KB.
+//
+// Supports the following interface:
+//
+//   hyperloglog S(p);        // empty sketch with 2^p registers, 4 <= p <= 18
+//   S.add(h);                // adds a key given its 64-bit hash
+//   S.merge(S2);             // S becomes the sketch of the union
+//   S.estimate();            // estimated number of distinct keys added
+//
+//   // sketch of f(0),...,f(n-1), where f returns 64-bit hashes, built
+//   // with one sketch per chunk of the input which are then merged
+//   hyperloglog build_hyperloglog(size_t n, F f, int p = 12);
+//
+//   // build_hyperloglog(n, f).estimate() rounded
+//   size_t estimate_distinct(size_t n, F f);
+//
+// The hashes must be well mixed over all 64 bits (e.g. parlay::hash64).
+
+namespace pbbs {
+
+  class hyperloglog {
+    int p;
+    parlay::sequence<uint8_t> registers;
+
+  public:
+    hyperloglog(int p = 12)
+      : p(p), registers(((size_t) 1) << p, (uint8_t) 0) {}
+
+    int precision() const {return p;}
+
+    // the top p bits pick a register, which keeps the largest position
+    // of the first one bit among the remaining bits
+    void add(uint64_t h) {
+      uint8_t rank = __builtin_clzll((h << p) | (((uint64_t) 1) << (p-1))) + 1;
+      uint8_t &r = registers[h >> (64 - p)];
+      if (rank > r) r = rank;
+    }
+
+    void merge(hyperloglog const &b) {
+      parlay::parallel_for(0, registers.size(), [&] (size_t j) {
+	registers[j] = std::max(registers[j], b.registers[j]);});
+    }
+
+    double estimate() const {
+      size_t m = registers.size();
+      double sum = parlay::reduce(parlay::delayed_map(registers, [] (uint8_t x) {
+	    return std::ldexp(1.0, -x);}));
+      double alpha = 0.7213 / (1.0 + 1.079 / m);
+      double e = alpha * m * m / sum;
+      // small range correction (linear counting on the empty registers)
+      size_t zeros = parlay::count(registers, (uint8_t) 0);
+      if (e <= 2.5 * m && zeros > 0) e = m * std::log((double) m / zeros);
+      return e;
+    }
+  };
+
+  template <class F>
+  hyperloglog build_hyperloglog(size_t n, F f, int p = 12) {
+    size_t m = ((size_t) 1) << p;
+    // a few chunks per worker, but not so many that merging dominates
+    size_t num_chunks = std::min(n / (16 * m) + 1, 4 * (size_t) parlay::num_workers());
+    auto sketches = parlay::tabulate(num_chunks, [&] (size_t c) {
+      hyperloglog S(p);
+      for (size_t i = c * n / num_chunks; i < (c+1) * n / num_chunks; i++)
+	S.add(f(i));
+      return S;}, 1);
+    hyperloglog result(p);
+    for (auto const &S : sketches) result.merge(S);
+    return result;
+  }
+
+  template <class F>
+  size_t estimate_distinct(size_t n, F f) {
+    return (size_t) std::round(build_hyperloglog(n, f).estimate());
+  }
+}
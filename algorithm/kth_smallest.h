@@ -1,25 +1,93 @@
 #pragma once
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include "../parlay/primitives.h"
 #include "../parlay/random.h"
 
 namespace pbbs {
   using namespace parlay;
 
+  // Copies In[0,n) to Out[0,n) partitioned into the elements less than,
+  // equal to, and greater than the pivot, and returns the ends of the
+  // first two parts.  One pass counts the parts in each block, and a
+  // second moves every element once.
+  template <class In_Seq, class T, class Compare>
+  std::pair<size_t,size_t> partition3(In_Seq const &In, T* Out, size_t n,
+				      T const &pivot, Compare less) {
+    constexpr size_t block_size = 2048;
+    size_t num_blocks = (n + block_size - 1) / block_size;
+    // counts[j*num_blocks + b] is the size of part j in block b
+    sequence<size_t> counts(3 * num_blocks);
+    parallel_for(0, num_blocks, [&] (size_t b) {
+      size_t c[3] = {0, 0, 0};
+      for (size_t i = b * block_size; i < std::min(n, (b+1) * block_size); i++)
+	c[less(In[i], pivot) ? 0 : (less(pivot, In[i]) ? 2 : 1)]++;
+      for (int j = 0; j < 3; j++) counts[j * num_blocks + b] = c[j];
+    }, 1);
+    scan_inplace(counts);
+    parallel_for(0, num_blocks, [&] (size_t b) {
+      size_t o[3];
+      for (int j = 0; j < 3; j++) o[j] = counts[j * num_blocks + b];
+      for (size_t i = b * block_size; i < std::min(n, (b+1) * block_size); i++)
+	Out[o[less(In[i], pivot) ? 0 : (less(pivot, In[i]) ? 2 : 1)]++] = In[i];
+    }, 1);
+    size_t num_less = (num_blocks == 0) ? 0 : counts[num_blocks];
+    size_t num_equal = (num_blocks == 0) ? 0 : counts[2 * num_blocks] - num_less;
+    return std::make_pair(num_less, num_less + num_equal);
+  }
+
+  // Returns the k-th smallest element (counting from 0) of s.
+  // Each round partitions the remaining candidates three ways around a
+  // random pivot, in one pass from one buffer into the other, and keeps
+  // the part holding the k-th.  The two buffers are allocated once and
+  // shrink geometrically in use, and small ranges finish in place with
+  // std::nth_element.
   template <class Seq, class Compare>
   auto kth_smallest(Seq const &s, size_t k, Compare less,
 		    parlay::random r = parlay::random()) {
     using T = typename Seq::value_type;
+    constexpr size_t base_size = 16384;
+    auto allocate = [] (size_t m) {
+      if constexpr (std::is_trivially_copyable<T>::value)
+	return sequence<T>::uninitialized(m);
+      else return sequence<T>(m);
+    };
     size_t n = s.size();
+    if (n <= base_size) {
+      sequence<T> A = to_sequence(s);
+      std::nth_element(A.begin(), A.begin() + k, A.end(), less);
+      return A[k];
+    }
+
     T pivot = s[r[0]%n];
-    sequence<T> smaller = filter(s, [&] (T a) {return less(a, pivot);});
-    if (k < smaller.size())
-      return kth_smallest(smaller, k, less, r.next());
-    else {
-      sequence<T> larger = filter(s, [&] (T a) {return less(pivot, a);});
-      if (k >= n - larger.size())
-	return kth_smallest(larger, k - n + larger.size(), less, r.next());
-      else return pivot;
+    sequence<T> A = allocate(n);
+    size_t lo, hi;
+    std::tie(lo, hi) = partition3(s, A.begin(), n, pivot, less);
+    if (k >= lo && k < hi) return pivot;
+    size_t start = (k < lo) ? 0 : hi;
+    n = (k < lo) ? lo : n - hi;
+    k -= start;
+
+    sequence<T> B = allocate(n > base_size ? n : 0);
+    T* src = A.begin() + start;
+    T* dst = B.begin();
+    while (n > base_size) {
+      r = r.next();
+      pivot = src[r[0]%n];
+      std::tie(lo, hi) = partition3(src, dst, n, pivot, less);
+      if (k >= lo && k < hi) return pivot;
+      start = (k < lo) ? 0 : hi;
+      n = (k < lo) ? lo : n - hi;
+      k -= start;
+      // the next round writes over the front of the buffer read this one
+      T* next_dst = (dst == B.begin()) ? A.begin() : B.begin();
+      src = dst + start;
+      dst = next_dst;
     }
+    std::nth_element(src, src + k, src + n, less);
+    return src[k];
   }
 
   template <class Seq, class Compare>
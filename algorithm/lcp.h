@@ -1,4 +1,6 @@
+#include <algorithm>
 #include "../parlay/sequence.h"
+#include "../parlay/parallel.h"
 #include "../parlay/internal/get_time.h"
 #include "range_min.h"
 
@@ -44,7 +46,7 @@ auto lcp(Seq1 const &s_, Seq2 const &SA_)
   //            remain holds indices of the rest of them (i.e., LCP[i] >= len)
   //      after round, len = 2*len and invariant holds for the new len
   do {
-    auto rq = make_range_min(L, std::less<Uint>(), 111);
+    auto rq = make_range_min<decltype(L), std::less<Uint>, Uint>(L, std::less<Uint>(), 111);
     t.next("make range");
 
     // see if next len chars resolves LCP
@@ -64,4 +66,84 @@ auto lcp(Seq1 const &s_, Seq2 const &SA_)
   return L_;
 }
 
+// The number of characters that s[p+h..] and s[q+h..] have in common,
+// plus h.  Long matches are compared in parallel, in windows that double
+// in size, so the work is proportional to the result.
+template <class Slice>
+size_t extend_match(Slice const &s, size_t p, size_t q, size_t h) {
+  size_t n = s.size();
+  size_t seq_len = h + (1 << 12);
+  while (h < seq_len && p + h < n && q + h < n && s[p+h] == s[q+h]) h++;
+  if (h < seq_len) return h;
+  for (size_t w = 1 << 12; p + h < n && q + h < n; w *= 2) {
+    size_t m = std::min(w, n - std::max(p, q) - h);
+    auto differ = parlay::delayed_tabulate(m, [&, h] (size_t i) {
+	return s[p+h+i] != s[q+h+i];});
+    size_t k = parlay::find_if(differ, [] (bool b) {return b;}) - differ.begin();
+    h += k;
+    if (k < m) break;
+  }
+  return h;
+}
+
+// Same result as lcp, computed from the permuted LCP array instead of
+// by doubling (Karkkainen, Manzini and Puglisi, "Permuted Longest-Common-
+// Prefix Array", CPM 2009).  With Phi[SA[i]] = SA[i-1], PLCP[p] is the
+// LCP of suffix p and suffix Phi[p], and PLCP[p+1] >= PLCP[p] - 1, so
+// filling PLCP in text order compares O(n) characters in total (as in
+// Kasai et al.).  For parallelism the text is cut into a few blocks per
+// worker.  PLCP at the block starts is found first, in order, each
+// starting from the bound given by the previous one, and each block then
+// starts from its exact value, so the total work stays O(n).  Unlike
+// doubling, whose number of rounds grows with the longest LCP, this does
+// not degrade on texts with very long repeats.
+// PLCP overwrites Phi in place, so it needs one array beyond the result.
+template <class Seq1, class Seq2>
+auto lcp_phi(Seq1 const &s_, Seq2 const &SA_)
+  -> parlay::sequence<typename Seq2::value_type>
+{
+  parlay::internal::timer t("LCP", false);
+  auto s = parlay::make_slice(s_); 
+  auto SA = parlay::make_slice(SA_);
+  using Uint = typename Seq2::value_type;
+  size_t n = SA.size();
+  if (n < 2) return parlay::sequence<Uint>();
+
+  // Phi, with n marking the first suffix, which has no predecessor
+  auto PLCP = parlay::sequence<Uint>::uninitialized(n);
+  parlay::parallel_for(0, n, [&] (size_t i) {
+      PLCP[SA[i]] = (i == 0) ? (Uint) n : SA[i-1];});
+  t.next("phi");
 
+  constexpr size_t min_block_size = 1 << 16;
+  size_t num_blocks = std::min(n / min_block_size + 1,
+			       4 * (size_t) parlay::num_workers());
+  size_t block_size = (n + num_blocks - 1) / num_blocks;
+
+  // PLCP at the start of each block
+  parlay::sequence<size_t> start_h(num_blocks);
+  size_t h = 0;
+  for (size_t b = 0; b < num_blocks; b++) {
+    size_t p = std::min(n - 1, b * block_size);
+    size_t q = PLCP[p];
+    h = (q == n) ? 0 : extend_match(s, p, q, h);
+    start_h[b] = h;
+    h = (h > block_size) ? h - block_size : 0;
+  }
+  t.next("block starts");
+
+  parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+      size_t h = start_h[b];
+      for (size_t p = b * block_size; p < std::min(n, (b+1) * block_size); p++) {
+	size_t q = PLCP[p];
+	if (q == n) h = 0;
+	else while (p + h < n && q + h < n && s[p+h] == s[q+h]) h++;
+	PLCP[p] = h;
+	if (h > 0) h--;
+      }
+    }, 1);
+  t.next("plcp");
+
+  return parlay::tabulate(n-1, [&] (size_t i) -> Uint {
+      return PLCP[SA[i+1]];});
+}
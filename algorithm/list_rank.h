@@ -0,0 +1,234 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Parallel list ranking: the position of each node of a set of linked
+// lists from the head of its list.
+//
+// The lists are given by a next array over nodes [0,n), with n marking
+// the end of a list.  A few nodes are sampled as extra heads (about one
+// in sample_rate), and each head walks its sublist up to the next head,
+// so each node is read once and no buffer space is needed however long
+// a sublist is.  The list of heads, weighted by sublist lengths, is
+// ranked by random-mate contraction: each round removes nodes whose coin
+// is tails while their predecessor's is heads (an independent set),
+// splicing them out, until few enough remain to rank sequentially, and
+// the removed nodes are put back in reverse order.  A second walk from
+// each head then gives the ranks of its sublist.
+//
+// The next array can also contain cycles (e.g. Euler tours).  A cycle
+// that no sample lands on is found since its nodes are not reached, and
+// is sampled again more densely.  Each cycle is ranked from an arbitrary
+// one of its nodes, which gets rank 0.
+//
+// Supports the following interface:
+//
+//   // rank of each node, for next[i] in [0,n] with each node having
+//   // at most one predecessor
+//   template <class Seq> parlay::sequence<typename Seq::value_type>
+//   list_rank(Seq const &next);
+//
+//   // calls f(i, rank of i) for each node i instead of storing the ranks
+//   template <class Seq, class F> void list_rank_apply(Seq const &next, F f);
+//
+// Seq can be any random access range (e.g. a delayed sequence) with an
+// integer value_type large enough to hold n.
+
+#pragma once
+#include <algorithm>
+#include <utility>
+#include "../parlay/parallel.h"
+#include "../parlay/primitives.h"
+#include "../parlay/sequence.h"
+#include "../parlay/random.h"
+#include "../parlay/internal/get_time.h"
+
+namespace pbbs {
+
+  namespace list_rank_internal {
+
+    // Sizes at or below this are ranked sequentially
+    constexpr size_t base_size = 10000;
+
+    // One in this many nodes starts a sublist
+    constexpr size_t sample_rate = 256;
+
+    // Weighted ranks (prefix sums of w along each list, not including
+    // the node itself) of a set of lists and cycles given by next,
+    // with next.size() marking the end of a list, by random-mate
+    // contraction.
+    template <class Int>
+    parlay::sequence<Int> weighted_rank(parlay::sequence<Int> next,
+					parlay::sequence<Int> w) {
+      size_t m = next.size();
+      auto P = parlay::sequence<Int>::uninitialized(m);
+      auto pred = parlay::sequence<Int>::uninitialized(m);
+      // for a removed node its predecessor, and the predecessor's weight
+      // when it was removed, which is its rank relative to that of pred
+      auto removed_pred = parlay::sequence<Int>::uninitialized(m);
+      auto offset = parlay::sequence<Int>::uninitialized(m);
+      parlay::sequence<parlay::sequence<Int>> rounds;
+      auto active = parlay::tabulate(m, [] (size_t i) {return (Int) i;});
+      auto set_pred = [&] {
+	parlay::parallel_for(0, active.size(), [&] (size_t j) {
+	    pred[active[j]] = (Int) m;});
+	parlay::parallel_for(0, active.size(), [&] (size_t j) {
+	    Int i = active[j];
+	    if (next[i] != m) pred[next[i]] = i;});
+      };
+
+      // nodes alone in their list or cycle are done, with rank 0
+      auto alone = [&] (Int i) {
+	return next[i] == i || (next[i] == m && pred[i] == m);};
+
+      parlay::random r(0);
+      while (true) {
+	set_pred();
+	parlay::parallel_for(0, active.size(), [&] (size_t j) {
+	    if (alone(active[j])) P[active[j]] = 0;});
+	active = parlay::filter(active, [&] (Int i) {return !alone(i);});
+	if (active.size() <= base_size) break;
+	r = r.next();
+	auto tails = [&] (Int i) {return (r.ith_rand(i) & 1) == 0;};
+	auto removable = [&] (Int i) {
+	  return pred[i] != m && tails(i) && !tails(pred[i]);};
+	auto removed = parlay::filter(active, removable);
+	// predecessors are not removed, so each is updated once
+	parlay::parallel_for(0, removed.size(), [&] (size_t j) {
+	    Int i = removed[j];
+	    Int p = pred[i];
+	    removed_pred[i] = p;
+	    offset[i] = w[p];
+	    w[p] += w[i];
+	    next[p] = next[i];});
+	active = parlay::filter(active, [&] (Int i) {return !removable(i);});
+	rounds.push_back(std::move(removed));
+      }
+
+      // rank what is left: first the lists, from their heads, then
+      // the cycles, each from its first remaining node
+      parlay::sequence<bool> done(m, false);
+      auto walk = [&] (Int h) {
+	Int x = h;
+	Int acc = 0;
+	do {
+	  P[x] = acc;
+	  done[x] = true;
+	  acc += w[x];
+	  x = next[x];
+	} while (x != m && x != h);
+      };
+      for (Int i : active) if (pred[i] == m) walk(i);
+      for (Int i : active) if (!done[i]) walk(i);
+
+      // put back the removed nodes, last round first
+      for (size_t k = rounds.size(); k > 0; k--) {
+	auto &removed = rounds[k-1];
+	parlay::parallel_for(0, removed.size(), [&] (size_t j) {
+	    Int i = removed[j];
+	    P[i] = P[removed_pred[i]] + offset[i];});
+      }
+      return P;
+    }
+  }
+
+  template <class Seq, class F>
+  void list_rank_apply(Seq const &next, F f) {
+    using namespace list_rank_internal;
+    using Int = typename Seq::value_type;
+    parlay::internal::timer t("list rank", false);
+    size_t n = next.size();
+    if (n == 0) return;
+
+    // 0: not reached yet, 1: head of a sublist, 2: reached from a head
+    parlay::sequence<unsigned char> state(n, 1);
+    parlay::parallel_for(0, n, [&] (size_t i) {
+	if (next[i] != n) state[next[i]] = 0;});
+    parlay::random r(0);
+    parlay::parallel_for(0, n, [&] (size_t i) {
+	if (r.ith_rand(i) % sample_rate == 0) state[i] = 1;});
+    t.next("sample");
+
+    // walks a sublist from a head up to (not including) the next head,
+    // calling g on each node and its position in the sublist, and
+    // returns the sublist length and what follows it (a head or n)
+    auto walk = [&] (Int head, auto g) {
+      Int pos = head;
+      Int k = 0;
+      do {
+	g(pos, k++);
+	pos = next[pos];
+      } while (pos != n && state[pos] != 1);
+      return std::make_pair(k, pos);
+    };
+
+    // walk from the new heads, marking what they reach, until every node
+    // is reached; nodes left are on cycles, which get denser samples
+    auto new_heads = parlay::pack_index<Int>(
+        parlay::delayed_map(state, [] (unsigned char x) {return x == 1;}));
+    parlay::sequence<Int> heads;
+    parlay::sequence<std::pair<Int,Int>> sublists;
+    size_t rate = sample_rate;
+    while (true) {
+      auto found = parlay::map(new_heads, [&] (Int h) {
+	  return walk(h, [&] (Int i, Int) {if (state[i] == 0) state[i] = 2;});}, 1);
+      heads.append(new_heads);
+      sublists.append(found);
+      auto left = parlay::pack_index<Int>(
+          parlay::delayed_map(state, [] (unsigned char x) {return x == 0;}));
+      if (left.size() == 0) break;
+      rate = std::max<size_t>(1, rate / 16);
+      r = r.next();
+      new_heads = parlay::filter(left, [&] (Int i) {
+	  return rate == 1 || r.ith_rand(i) % rate == 0;});
+      parlay::parallel_for(0, new_heads.size(), [&] (size_t j) {
+	  state[new_heads[j]] = 1;});
+    }
+    t.next("sublists");
+
+    // the list of heads, weighted by sublist length, in order of head
+    size_t m = heads.size();
+    auto order = parlay::sort(parlay::tabulate(m, [] (size_t j) {return (Int) j;}),
+			      [&] (Int a, Int b) {return heads[a] < heads[b];});
+    auto sorted_heads = parlay::map(order, [&] (Int j) {return heads[j];});
+    auto next_head = parlay::map(order, [&] (Int j) -> Int {
+	Int after = sublists[j].second;
+	if (after == n) return (Int) m;
+	return (Int) (std::lower_bound(sorted_heads.begin(), sorted_heads.end(), after)
+		      - sorted_heads.begin());});
+    auto lengths = parlay::map(order, [&] (Int j) {return sublists[j].first;});
+    auto P = weighted_rank(std::move(next_head), std::move(lengths));
+    t.next("rank heads");
+
+    parlay::parallel_for(0, m, [&] (size_t j) {
+	Int base = P[j];
+	walk(sorted_heads[j], [&] (Int i, Int k) {f(i, base + k);});}, 1);
+    t.next("rank sublists");
+  }
+
+  template <class Seq>
+  parlay::sequence<typename Seq::value_type> list_rank(Seq const &next) {
+    using Int = typename Seq::value_type;
+    auto ranks = parlay::sequence<Int>::uninitialized(next.size());
+    list_rank_apply(next, [&] (Int i, Int k) {ranks[i] = k;});
+    return ranks;
+  }
+}
@@ -0,0 +1,182 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Compressed posting lists for an inverted index: a sorted set of words,
+// each with the sorted list of documents (32-bit ids) it appears in.
+// A list is stored as the Stream VByte coding of the differences of its
+// ids (see stream_vbyte.h), and all lists share one byte buffer, as the
+// words share one string_pool.
+//
+//   posting_lists P(words, lists);  // words[i] (sorted, with data() and
+//                                   // size()) has the sorted ids lists[i]
+//   P.size()               // number of words
+//   P.word(i)              // word i, as a string_view
+//   P.find(w)              // index of word w, or size() if absent
+//   P.list_size(i)         // number of documents of word i
+//   P.decode(i, out)       // writes them to out[0, list_size(i))
+//   P.list(i)              // or returns them in a sequence
+//   P.num_postings()       // sum of list sizes
+//   P.posting_bytes()      // bytes of the coded lists
+//   P.total_bytes()        // bytes of the whole structure
+//   P.to_bytes()           // binary format, see below
+//   posting_lists::from_bytes(B)
+//
+// The binary format is, with all integers little endian:
+//   "PBBSIDX1", then as 64-bit integers the number of words W, the number
+//   of postings, the bytes of all words, and the bytes of all lists,
+//   then W+1 64-bit word offsets, the characters of the words,
+//   W+1 64-bit list offsets, W 32-bit list sizes, and the coded lists.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include "../parlay/primitives.h"
+#include "../parlay/parallel.h"
+#include "../common/stringPool.h"
+#include "stream_vbyte.h"
+
+namespace pbbs {
+
+  class posting_lists {
+    benchIO::string_pool words;
+    parlay::sequence<size_t> offsets;  // list i is bytes[offsets[i], offsets[i+1])
+    parlay::sequence<uint32_t> counts;
+    parlay::sequence<uint8_t> bytes;
+
+    static constexpr char magic[9] = "PBBSIDX1";
+
+    posting_lists() {}
+
+  public:
+    template <class Words, class Lists>
+    posting_lists(Words const &W, Lists const &L) : words(W) {
+      size_t n = W.size();
+      counts = parlay::tabulate(n, [&] (size_t i) -> uint32_t {return L[i].size();});
+      offsets = parlay::tabulate(n + 1, [&] (size_t i) -> size_t {
+	  return (i == n) ? 0 : svb_delta_bytes(L[i].begin(), L[i].size(), 0);});
+      size_t m = parlay::scan_inplace(offsets);
+      bytes = parlay::sequence<uint8_t>::uninitialized(m);
+      parlay::parallel_for(0, n, [&] (size_t i) {
+	svb_encode_delta(L[i].begin(), L[i].size(), 0, bytes.begin() + offsets[i]);});
+    }
+
+    size_t size() const {return counts.size();}
+    std::string_view word(size_t i) const {return words[i];}
+    size_t list_size(size_t i) const {return counts[i];}
+
+    size_t find(std::string_view w) const {
+      size_t lo = 0, hi = size();
+      while (lo < hi) {
+	size_t mid = (lo + hi) / 2;
+	if (words[mid] < w) lo = mid + 1;
+	else hi = mid;
+      }
+      return (lo < size() && words[lo] == w) ? lo : size();
+    }
+
+    void decode(size_t i, uint32_t* out) const {
+      svb_decode_delta(bytes.begin() + offsets[i], offsets[i+1] - offsets[i],
+		       counts[i], 0, out);
+    }
+
+    parlay::sequence<uint32_t> list(size_t i) const {
+      auto out = parlay::sequence<uint32_t>::uninitialized(counts[i]);
+      decode(i, out.begin());
+      return out;
+    }
+
+    size_t num_postings() const {
+      return parlay::reduce(parlay::delayed_map(counts, [] (uint32_t c) -> size_t {
+	    return c;}));}
+
+    size_t posting_bytes() const {return bytes.size();}
+
+    size_t total_bytes() const {
+      return (bytes.size() + offsets.size() * sizeof(size_t) +
+	      counts.size() * sizeof(uint32_t) + words.char_bytes() +
+	      (size() + 1) * sizeof(size_t));
+    }
+
+    parlay::sequence<char> to_bytes() const {
+      size_t n = size();
+      uint64_t header[4] = {n, num_postings(), words.char_bytes(), bytes.size()};
+      parlay::sequence<char> out;
+      auto put = [&] (void const* p, size_t len) {
+	out.append(parlay::make_slice((char const*) p, (char const*) p + len));};
+      put(magic, 8);
+      put(header, sizeof(header));
+      put(words.offset_data(), (n + 1) * sizeof(size_t));
+      put(words.char_data(), words.char_bytes());
+      put(offsets.begin(), (n + 1) * sizeof(size_t));
+      put(counts.begin(), n * sizeof(uint32_t));
+      put(bytes.begin(), bytes.size());
+      return out;
+    }
+
+    static posting_lists from_bytes(parlay::sequence<char> const &B) {
+      if (B.size() < 40 || std::memcmp(B.begin(), magic, 8) != 0) {
+	std::cout << "posting_lists: not a binary index" << std::endl;
+	abort();
+      }
+      uint64_t header[4];
+      std::memcpy(header, B.begin() + 8, sizeof(header));
+      size_t n = header[0];
+      auto corrupt = [] {
+	std::cout << "posting_lists: binary index is truncated or corrupt" << std::endl;
+	abort();
+      };
+      // a word takes at least 20 bytes (two offsets and a size), which
+      // also keeps the sum from overflowing
+      if (n > B.size() / 20 || header[2] > B.size() || header[3] > B.size() ||
+	  40 + 16 * (n + 1) + 4 * n + header[2] + header[3] > B.size())
+	corrupt();
+      char const* p = B.begin() + 40;
+      auto get = [&] (auto &seq, size_t count) {
+	using T = typename std::remove_reference_t<decltype(seq)>::value_type;
+	seq = parlay::sequence<T>::uninitialized(count);
+	std::memcpy(seq.begin(), p, count * sizeof(T));
+	p += count * sizeof(T);
+      };
+      posting_lists P;
+      parlay::sequence<size_t> word_offsets;
+      parlay::sequence<char> word_chars;
+      get(word_offsets, n + 1);
+      get(word_chars, header[2]);
+      P.words = benchIO::string_pool(std::move(word_chars), std::move(word_offsets));
+      get(P.offsets, n + 1);
+      get(P.counts, n);
+      get(P.bytes, header[3]);
+      // offsets must run from 0 up to the sizes in the header
+      auto bad_offsets = [&] (size_t const* o, size_t end) {
+	auto down = parlay::delayed_tabulate(n, [&] (size_t i) {return o[i] > o[i+1];});
+	return o[0] != 0 || o[n] != end || parlay::count_if(down, [] (bool b) {return b;}) > 0;};
+      if (bad_offsets(P.words.offset_data(), header[2]) ||
+	  bad_offsets(P.offsets.begin(), header[3]))
+	corrupt();
+      return P;
+    }
+  };
+}
@@ -32,6 +32,8 @@
 //    also takes an optional block_size argument (default = 32)
 //  query(i,j) finds the minimum in the range from i to j inclusive of both
 //    and returns its index
+//  the indices are of type Uint (unsigned int by default), which needs
+//    to hold n, e.g. unsigned long or pbbs::uint40 for n >= 2^32
 // Assuming less takes constant time:
 //   Build takes O(n log n / block_size) time
 //   Query takes O(block_size) time
@@ -78,7 +80,7 @@ public:
       outOfBlockMin = table[1][block_i];
     else {
       long k = parlay::log2_up(block_j - block_i + 1) - 1;
-      long p = 1 << k; //2^k
+      long p = ((long) 1) << k; //2^k
       outOfBlockMin = min_index(table[k][block_i], table[k][block_j+1-p]);
     }
     return min_index(minl, min_index(outOfBlockMin, minr));
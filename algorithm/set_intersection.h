@@ -0,0 +1,158 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Intersection of two sorted lists of distinct 32-bit integers, as for
+// the posting lists of an inverted index.
+//
+// When the lists have similar lengths a merge is best.  The AVX2 merge
+// compares a block of 8 from each list all against all (8 rotations of
+// one block), packs the matches of the first block to the output with
+// one permute, and advances the block with the smaller last element.
+// When one list is much shorter, each of its elements is instead found
+// in the longer list by galloping (exponential then binary search) from
+// where the previous one was found.
+//
+// Supports the following interface, where out needs room for
+// min(na, nb) + intersect_slack values (the vector merge stores 8 lanes
+// at a time) and each call returns the number written:
+//
+//   size_t intersect_merge(uint32_t const* a, size_t na,
+//                          uint32_t const* b, size_t nb, uint32_t* out);
+//   size_t intersect_gallop(...);  // same arguments, best when na << nb
+//   size_t intersect(...);         // picks one by the ratio of the lengths
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "simd_level.h"
+
+#ifdef PBBS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace pbbs {
+
+  // intersect gallops when one list is this many times longer
+  constexpr size_t gallop_ratio = 32;
+  constexpr size_t intersect_slack = 8;
+
+  namespace set_intersection {
+
+    inline size_t merge_scalar(uint32_t const* a, size_t na,
+			       uint32_t const* b, size_t nb, uint32_t* out) {
+      size_t i = 0, j = 0, k = 0;
+      while (i < na && j < nb) {
+	uint32_t x = a[i], y = b[j];
+	out[k] = x;
+	k += (x == y);
+	i += (x <= y);
+	j += (y <= x);
+      }
+      return k;
+    }
+
+#ifdef PBBS_SIMD_X86
+    // for each 8-bit mask, the lanes of its set bits packed to the front
+    struct pack_table {
+      uint32_t lanes[256][8];
+    };
+
+    inline pack_table const &get_pack_table() {
+      static const pack_table t = [] {
+	pack_table t;
+	for (int m = 0; m < 256; m++) {
+	  int k = 0;
+	  for (int j = 0; j < 8; j++)
+	    if (m & (1 << j)) t.lanes[m][k++] = j;
+	  while (k < 8) t.lanes[m][k++] = 0;
+	}
+	return t;
+      }();
+      return t;
+    }
+
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+    inline size_t merge_avx2(uint32_t const* a, size_t na,
+			     uint32_t const* b, size_t nb, uint32_t* out) {
+      auto const &pack = get_pack_table();
+      const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+      size_t i = 0, j = 0, k = 0;
+      while (i + 8 <= na && j + 8 <= nb) {
+	__m256i va = _mm256_loadu_si256((__m256i const*) (a + i));
+	__m256i vb = _mm256_loadu_si256((__m256i const*) (b + j));
+	__m256i eq = _mm256_cmpeq_epi32(va, vb);
+	for (int r = 1; r < 8; r++) {
+	  vb = _mm256_permutevar8x32_epi32(vb, rotate);
+	  eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+	}
+	int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+	__m256i idx = _mm256_loadu_si256((__m256i const*) pack.lanes[mask]);
+	_mm256_storeu_si256((__m256i*) (out + k), _mm256_permutevar8x32_epi32(va, idx));
+	k += _mm_popcnt_u32(mask);
+	uint32_t amax = a[i+7], bmax = b[j+7];
+	i += (amax <= bmax) ? 8 : 0;
+	j += (bmax <= amax) ? 8 : 0;
+      }
+      // matches already written are all below the rest of the other list
+      return k + merge_scalar(a + i, na - i, b + j, nb - j, out + k);
+    }
+#pragma GCC pop_options
+#endif
+  }
+
+  inline size_t intersect_merge(uint32_t const* a, size_t na,
+				uint32_t const* b, size_t nb, uint32_t* out) {
+#ifdef PBBS_SIMD_X86
+    if (detected_simd_level() != simd_level::none)
+      return set_intersection::merge_avx2(a, na, b, nb, out);
+#endif
+    return set_intersection::merge_scalar(a, na, b, nb, out);
+  }
+
+  inline size_t intersect_gallop(uint32_t const* a, size_t na,
+				 uint32_t const* b, size_t nb, uint32_t* out) {
+    size_t j = 0, k = 0;
+    for (size_t i = 0; i < na && j < nb; i++) {
+      uint32_t x = a[i];
+      // find a range (lo, hi] of b holding the first element >= x
+      size_t lo = j, step = 1;
+      while (lo + step < nb && b[lo + step] < x) {
+	lo += step;
+	step *= 2;
+      }
+      size_t hi = std::min(lo + step, nb);
+      j = std::lower_bound(b + lo, b + hi, x) - b;
+      if (j < nb && b[j] == x) out[k++] = x;
+    }
+    return k;
+  }
+
+  inline size_t intersect(uint32_t const* a, size_t na,
+			  uint32_t const* b, size_t nb, uint32_t* out) {
+    if (na > nb) return intersect(b, nb, a, na, out);
+    if (na * gallop_ratio < nb) return intersect_gallop(a, na, b, nb, out);
+    return intersect_merge(a, na, b, nb, out);
+  }
+}
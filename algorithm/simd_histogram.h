@@ -0,0 +1,163 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Counting of small radix digits (at most 16 bits), as in a histogram
+// with few buckets or the counting pass of a radix sort.
+//
+// A counting loop that increments the same counter twice in a row must
+// wait for the first store before it can load the counter again, which
+// is the common case for skewed or low-entropy digits.  These kernels
+// rotate through K copies of the counters, so consecutive keys update
+// different copies.  The copies are interleaved (copy j of digit d is at
+// d*K + j), so the copies of a digit share a cache line and summing them
+// at the end is one pass.  K is 4 for digits of up to 8 bits (4KB of
+// counters) and 2 for up to 16 bits.  For 32-bit keys, or pairs with a
+// 32-bit first element, the digits of eight keys at a time are extracted
+// with AVX2 when the processor has it.
+//
+// Supports the following interface:
+//
+//   // counts[d] += number of i with (key(A[i]) >> shift) mod 2^bits == d,
+//   // where key is the element itself or the first of a pair, for
+//   // 32-bit keys, bits <= 16, and n < 2^32
+//   void digit_histogram(T const* A, size_t n, int shift, int bits, uint32_t* counts);
+//
+//   // same for any key, given as a function returning an unsigned integer
+//   void digit_histogram(T const* A, size_t n, Key key, int shift, int bits,
+//                        uint32_t* counts);
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include "../parlay/sequence.h"
+#include "simd_level.h"
+
+#ifdef PBBS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace pbbs {
+
+  // true for 32-bit integer keys and for pairs of 32-bit values
+  template <class T>
+  struct has_key32 {
+    static constexpr bool value = std::is_integral<T>::value && sizeof(T) == 4;};
+  template <class E, class F>
+  struct has_key32<std::pair<E,F>> {
+    static constexpr bool value = (std::is_integral<E>::value && sizeof(E) == 4 &&
+				   sizeof(F) == 4);};
+
+  namespace sub_histogram {
+
+    template <class T>
+    uint32_t key32(T const &x) {
+      if constexpr (std::is_integral<T>::value) return (uint32_t) x;
+      else return (uint32_t) x.first;
+    }
+
+    // counts positions [start, n) into the interleaved counters C
+    template <int K, class T, class Key>
+    void count_scalar(T const* A, size_t start, size_t n, Key key,
+		      int shift, uint32_t mask, uint32_t* C) {
+      size_t i = start;
+      for (; i + K <= n; i += K)
+	for (int j = 0; j < K; j++)
+	  C[((key(A[i+j]) >> shift) & mask) * K + j]++;
+      for (; i < n; i++) C[((key(A[i]) >> shift) & mask) * K]++;
+    }
+
+#ifdef PBBS_SIMD_X86
+#pragma GCC push_options
+#pragma GCC target("avx2")
+    // counts the longest prefix of A whose length is a multiple of 8,
+    // and returns its length
+    template <int K, class T>
+    size_t count_avx2(T const* A, size_t n, int shift, uint32_t mask, uint32_t* C) {
+      constexpr bool pairs = (sizeof(T) == 8);
+      uint32_t const* P = (uint32_t const*) A;
+      __m128i sh = _mm_cvtsi32_si128(shift);
+      __m256i m = _mm256_set1_epi32(mask);
+      alignas(32) uint32_t d[8];
+      size_t i = 0;
+      for (; i + 8 <= n; i += 8) {
+	__m256i v;
+	if constexpr (pairs) {
+	  // keys are the even words; their order does not matter here
+	  __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256((__m256i const*) (P + 2*i)));
+	  __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256((__m256i const*) (P + 2*i + 8)));
+	  v = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+	} else v = _mm256_loadu_si256((__m256i const*) (P + i));
+	_mm256_store_si256((__m256i*) d, _mm256_and_si256(_mm256_srl_epi32(v, sh), m));
+	for (int j = 0; j < 8; j++) C[d[j] * K + j % K]++;
+      }
+      return i;
+    }
+#pragma GCC pop_options
+#endif
+
+    template <int K, bool vectorize, class T, class Key>
+    void count(T const* A, size_t n, Key key, int shift, int bits, uint32_t* counts) {
+      size_t num_digits = ((size_t) 1) << bits;
+      uint32_t mask = (uint32_t) (num_digits - 1);
+      auto C = parlay::sequence<uint32_t>(num_digits * K, (uint32_t) 0);
+      size_t start = 0;
+#ifdef PBBS_SIMD_X86
+      if constexpr (vectorize)
+	if (detected_simd_level() != simd_level::none)
+	  start = count_avx2<K>(A, n, shift, mask, C.begin());
+#endif
+      count_scalar<K>(A, start, n, key, shift, mask, C.begin());
+      for (size_t d = 0; d < num_digits; d++) {
+	uint32_t sum = 0;
+	for (int j = 0; j < K; j++) sum += C[d * K + j];
+	counts[d] += sum;
+      }
+    }
+
+    template <bool vectorize, class T, class Key>
+    void dispatch(T const* A, size_t n, Key key, int shift, int bits, uint32_t* counts) {
+      if (bits <= 8) count<4, vectorize>(A, n, key, shift, bits, counts);
+      else if (bits <= 16) count<2, vectorize>(A, n, key, shift, bits, counts);
+      else {
+	std::cout << "digit_histogram: at most 16 bits per digit" << std::endl;
+	abort();
+      }
+    }
+  }
+
+  template <class T>
+  void digit_histogram(T const* A, size_t n, int shift, int bits, uint32_t* counts) {
+    static_assert(has_key32<T>::value, "digit_histogram: needs 32-bit keys");
+    sub_histogram::dispatch<true>(A, n, [] (T const &x) {
+	return sub_histogram::key32(x);}, shift, bits, counts);
+  }
+
+  template <class T, class Key>
+  void digit_histogram(T const* A, size_t n, Key key, int shift, int bits,
+		       uint32_t* counts) {
+    sub_histogram::dispatch<false>(A, n, key, shift, bits, counts);
+  }
+}
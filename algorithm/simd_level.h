@@ -0,0 +1,51 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Runtime detection of the x86 vector instruction set, for kernels that
+// compile several versions with "#pragma GCC target" and pick one when
+// they run.  Defines PBBS_SIMD_X86 when such kernels can be compiled
+// (x86-64 with gcc); otherwise detected_simd_level() is always none.
+
+#pragma once
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define PBBS_SIMD_X86 1
+#endif
+
+namespace pbbs {
+
+  enum class simd_level {none, avx2, avx512};
+
+  inline simd_level detected_simd_level() {
+#ifdef PBBS_SIMD_X86
+    static const simd_level level = [] {
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) return simd_level::avx512;
+      if (__builtin_cpu_supports("avx2")) return simd_level::avx2;
+      return simd_level::none;
+    }();
+    return level;
+#else
+    return simd_level::none;
+#endif
+  }
+}
@@ -0,0 +1,200 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// A sequential sort for int, float and double keys built from SIMD
+// sorting networks and a bitonic merge (see simd_sort_network.h).
+// It is meant as a base case for parallel sorts, e.g. to finish the
+// buckets of a sample sort.
+//
+// Supports the following interface:
+//
+//   // true for the key types that have a vectorized sort
+//   template <class T> constexpr bool simd_sortable;
+//
+//   // sorts A[0,n) in ascending order, using Tmp[0,n) as scratch space
+//   template <class T> void simd_sort(T* A, T* Tmp, size_t n);
+//
+// The instruction set is picked at runtime: AVX-512 if the processor
+// supports it, else AVX2, else std::sort.  The vectorized code is compiled
+// with "#pragma GCC target" so no -march flag is needed, and non-x86 or
+// non-gcc builds always use std::sort.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#include "simd_level.h"
+
+#ifdef PBBS_SIMD_X86
+#define PBBS_SIMD_SORT 1
+#include <immintrin.h>
+#endif
+
+namespace pbbs {
+
+#ifdef PBBS_SIMD_SORT
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace simd_avx2 {
+
+  struct int_traits {
+    using T = int;
+    using V = __m256i;
+    static constexpr int L = 8;
+    static V load(const T* p) {return _mm256_loadu_si256((const V*) p);}
+    static void store(T* p, V v) {_mm256_storeu_si256((V*) p, v);}
+    static V min(V a, V b) {return _mm256_min_epi32(a, b);}
+    static V max(V a, V b) {return _mm256_max_epi32(a, b);}
+    template <int j> static V xor_permute(V v) {
+      return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0^j, 1^j, 2^j, 3^j,
+							      4^j, 5^j, 6^j, 7^j));}
+    template <unsigned int mask> static V blend(V a, V b) {
+      return _mm256_blend_epi32(a, b, mask);}
+  };
+
+  struct float_traits {
+    using T = float;
+    using V = __m256;
+    static constexpr int L = 8;
+    static V load(const T* p) {return _mm256_loadu_ps(p);}
+    static void store(T* p, V v) {_mm256_storeu_ps(p, v);}
+    static V min(V a, V b) {return _mm256_min_ps(a, b);}
+    static V max(V a, V b) {return _mm256_max_ps(a, b);}
+    template <int j> static V xor_permute(V v) {
+      return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(0^j, 1^j, 2^j, 3^j,
+							   4^j, 5^j, 6^j, 7^j));}
+    template <unsigned int mask> static V blend(V a, V b) {
+      return _mm256_blend_ps(a, b, mask);}
+  };
+
+  struct double_traits {
+    using T = double;
+    using V = __m256d;
+    static constexpr int L = 4;
+    static V load(const T* p) {return _mm256_loadu_pd(p);}
+    static void store(T* p, V v) {_mm256_storeu_pd(p, v);}
+    static V min(V a, V b) {return _mm256_min_pd(a, b);}
+    static V max(V a, V b) {return _mm256_max_pd(a, b);}
+    template <int j> static V xor_permute(V v) {
+      return _mm256_permute4x64_pd(v, (0^j) | ((1^j) << 2) | ((2^j) << 4) | ((3^j) << 6));}
+    template <unsigned int mask> static V blend(V a, V b) {
+      return _mm256_blend_pd(a, b, mask);}
+  };
+
+#include "simd_sort_network.h"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace simd_avx512 {
+
+  struct int_traits {
+    using T = int;
+    using V = __m512i;
+    static constexpr int L = 16;
+    static V load(const T* p) {return _mm512_loadu_si512(p);}
+    static void store(T* p, V v) {_mm512_storeu_si512(p, v);}
+    static V min(V a, V b) {return _mm512_min_epi32(a, b);}
+    static V max(V a, V b) {return _mm512_max_epi32(a, b);}
+    template <int j> static V xor_permute(V v) {
+      return _mm512_permutexvar_epi32(_mm512_setr_epi32(0^j, 1^j, 2^j, 3^j, 4^j, 5^j, 6^j, 7^j,
+							8^j, 9^j, 10^j, 11^j, 12^j, 13^j, 14^j, 15^j), v);}
+    template <unsigned int mask> static V blend(V a, V b) {
+      return _mm512_mask_blend_epi32((__mmask16) mask, a, b);}
+  };
+
+  struct float_traits {
+    using T = float;
+    using V = __m512;
+    static constexpr int L = 16;
+    static V load(const T* p) {return _mm512_loadu_ps(p);}
+    static void store(T* p, V v) {_mm512_storeu_ps(p, v);}
+    static V min(V a, V b) {return _mm512_min_ps(a, b);}
+    static V max(V a, V b) {return _mm512_max_ps(a, b);}
+    template <int j> static V xor_permute(V v) {
+      return _mm512_permutexvar_ps(_mm512_setr_epi32(0^j, 1^j, 2^j, 3^j, 4^j, 5^j, 6^j, 7^j,
+						     8^j, 9^j, 10^j, 11^j, 12^j, 13^j, 14^j, 15^j), v);}
+    template <unsigned int mask> static V blend(V a, V b) {
+      return _mm512_mask_blend_ps((__mmask16) mask, a, b);}
+  };
+
+  struct double_traits {
+    using T = double;
+    using V = __m512d;
+    static constexpr int L = 8;
+    static V load(const T* p) {return _mm512_loadu_pd(p);}
+    static void store(T* p, V v) {_mm512_storeu_pd(p, v);}
+    static V min(V a, V b) {return _mm512_min_pd(a, b);}
+    static V max(V a, V b) {return _mm512_max_pd(a, b);}
+    template <int j> static V xor_permute(V v) {
+      return _mm512_permutexvar_pd(_mm512_setr_epi64(0^j, 1^j, 2^j, 3^j,
+						     4^j, 5^j, 6^j, 7^j), v);}
+    template <unsigned int mask> static V blend(V a, V b) {
+      return _mm512_mask_blend_pd((__mmask8) mask, a, b);}
+  };
+
+#include "simd_sort_network.h"
+}
+#pragma GCC pop_options
+
+  template <class T> struct simd_traits {};
+  template <> struct simd_traits<int> {
+    using avx2 = simd_avx2::int_traits; using avx512 = simd_avx512::int_traits;};
+  template <> struct simd_traits<float> {
+    using avx2 = simd_avx2::float_traits; using avx512 = simd_avx512::float_traits;};
+  template <> struct simd_traits<double> {
+    using avx2 = simd_avx2::double_traits; using avx512 = simd_avx512::double_traits;};
+
+#endif // PBBS_SIMD_SORT
+
+  template <class T>
+  constexpr bool simd_sortable = (std::is_same<T,int>::value ||
+				  std::is_same<T,float>::value ||
+				  std::is_same<T,double>::value);
+
+  template <class T>
+  void simd_sort(T* A, T* Tmp, size_t n) {
+    static_assert(simd_sortable<T>, "simd_sort: only int, float and double keys");
+#ifdef PBBS_SIMD_SORT
+    switch (detected_simd_level()) {
+    case simd_level::avx512:
+      if (n >= 2 * simd_traits<T>::avx512::L) {
+	simd_avx512::sort_array<typename simd_traits<T>::avx512>(A, Tmp, n);
+	return;
+      }
+      break;
+    case simd_level::avx2:
+      if (n >= 2 * simd_traits<T>::avx2::L) {
+	simd_avx2::sort_array<typename simd_traits<T>::avx2>(A, Tmp, n);
+	return;
+      }
+      break;
+    default: break;
+    }
+#endif
+    std::sort(A, A + n);
+  }
+}
@@ -0,0 +1,139 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Sorting networks and a bitonic merge sort over SIMD registers.
+// Not a standalone header: simd_sort.h includes it once per instruction
+// set, inside a namespace and a "#pragma GCC target" region, after
+// defining the register traits for that instruction set.
+// A traits class Tr supplies:
+//    T, V    : the element and register types, with L lanes per register
+//    load, store, min, max
+//    xor_permute<j>(v)   : lane i gets lane i^j
+//    blend<mask>(a, b)   : lane i gets b if bit i of mask is set, else a
+
+// lane i of a compare-exchange stage takes the max if its partner i^j is
+// below it in an ascending block (bit k of i clear), or above it in a
+// descending one
+constexpr unsigned int take_max_mask(int k, int j, int L) {
+  unsigned int mask = 0;
+  for (int i = 0; i < L; i++)
+    if (((i & j) != 0) == ((i & k) == 0)) mask |= (1u << i);
+  return mask;
+}
+
+template <class Tr, int k, int j>
+inline typename Tr::V network_stage(typename Tr::V v) {
+  auto p = Tr::template xor_permute<j>(v);
+  // min(v,p) with max(p,v) keeps both of two equal values (e.g. -0.0, 0.0)
+  return Tr::template blend<take_max_mask(k, j, Tr::L)>(Tr::min(v, p), Tr::max(p, v));
+}
+
+template <class Tr, int k, int j>
+inline typename Tr::V merge_stages(typename Tr::V v) {
+  if constexpr (j == 0) return v;
+  else return merge_stages<Tr, k, j/2>(network_stage<Tr, k, j>(v));
+}
+
+// bitonic sort of the L lanes of one register
+template <class Tr, int k = 2>
+inline typename Tr::V sort_vector(typename Tr::V v) {
+  if constexpr (k > Tr::L) return v;
+  else return sort_vector<Tr, 2*k>(merge_stages<Tr, k, k/2>(v));
+}
+
+// merges two sorted registers, returning the L smallest in lo and the
+// L largest in hi, both sorted
+template <class Tr>
+inline void merge_vectors(typename Tr::V a, typename Tr::V b,
+			  typename Tr::V &lo, typename Tr::V &hi) {
+  b = Tr::template xor_permute<Tr::L-1>(b);  // reverse, so a:b is bitonic
+  lo = merge_stages<Tr, Tr::L, Tr::L/2>(Tr::min(a, b));
+  hi = merge_stages<Tr, Tr::L, Tr::L/2>(Tr::max(b, a));
+}
+
+// merges two sorted runs whose lengths are nonzero multiples of L
+template <class Tr, class T = typename Tr::T>
+void merge_runs(const T* a, size_t na, const T* b, size_t nb, T* out) {
+  constexpr size_t L = Tr::L;
+  typename Tr::V lo, hi;
+  merge_vectors<Tr>(Tr::load(a), Tr::load(b), lo, hi);
+  Tr::store(out, lo);
+  out += L;
+  size_t ia = L, ib = L;
+  while (ia < na || ib < nb) {
+    typename Tr::V next;
+    if (ib == nb || (ia < na && a[ia] < b[ib])) {
+      next = Tr::load(a + ia); ia += L;
+    } else {
+      next = Tr::load(b + ib); ib += L;
+    }
+    merge_vectors<Tr>(next, hi, lo, hi);
+    Tr::store(out, lo);
+    out += L;
+  }
+  Tr::store(out, hi);
+}
+
+// Sorts A[0,n) using Tmp[0,n) as scratch space.
+// Each register-sized block is sorted by a network, the leftover tail by
+// insertion sort, and runs are then merged bottom up.  Merges of two
+// full-register runs use the bitonic merge, any merge with the tail is scalar.
+template <class Tr, class T = typename Tr::T>
+void sort_array(T* A, T* Tmp, size_t n) {
+  constexpr size_t L = Tr::L;
+  size_t nv = n / L;
+
+  for (size_t i = 0; i + 4 <= nv; i += 4) {
+    // four independent networks at a time to overlap their latencies
+    auto v0 = sort_vector<Tr>(Tr::load(A + i*L));
+    auto v1 = sort_vector<Tr>(Tr::load(A + (i+1)*L));
+    auto v2 = sort_vector<Tr>(Tr::load(A + (i+2)*L));
+    auto v3 = sort_vector<Tr>(Tr::load(A + (i+3)*L));
+    Tr::store(A + i*L, v0);
+    Tr::store(A + (i+1)*L, v1);
+    Tr::store(A + (i+2)*L, v2);
+    Tr::store(A + (i+3)*L, v3);
+  }
+  for (size_t i = nv - nv%4; i < nv; i++)
+    Tr::store(A + i*L, sort_vector<Tr>(Tr::load(A + i*L)));
+  for (size_t i = nv*L + 1; i < n; i++) {
+    T x = A[i];
+    size_t j = i;
+    for (; j > nv*L && x < A[j-1]; j--) A[j] = A[j-1];
+    A[j] = x;
+  }
+
+  T* src = A;
+  T* dst = Tmp;
+  for (size_t w = L; w < n; w *= 2) {
+    for (size_t s = 0; s < n; s += 2*w) {
+      size_t m = std::min(s + w, n);
+      size_t e = std::min(s + 2*w, n);
+      if (m == e) std::copy(src + s, src + e, dst + s);
+      else if ((e - m) % L == 0)
+	merge_runs<Tr>(src + s, m - s, src + m, e - m, dst + s);
+      else std::merge(src + s, src + m, src + m, src + e, dst + s);
+    }
+    std::swap(src, dst);
+  }
+  if (src != A) std::copy(src, src + n, A);
+}
@@ -0,0 +1,160 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Stream VByte coding of 32-bit integers (Lemire, Kurz and Rupp, "Stream
+// VByte: Faster Byte-Oriented Integer Compression", 2018), here always
+// applied to the differences of a non-decreasing sequence, as for the
+// document ids of a posting list.
+//
+// Each value takes 1 to 4 bytes.  The lengths are kept apart from the
+// values, two bits each in control bytes that all come first, so that a
+// decoder can read the lengths of four values from one control byte and
+// move their bytes into place with one shuffle.  The shuffle needs SSSE3
+// and is picked at runtime; otherwise decoding is scalar.
+//
+// Supports the following interface:
+//
+//   // bytes needed to encode the differences of in[0,n), starting from prev
+//   size_t svb_delta_bytes(uint32_t const* in, size_t n, uint32_t prev);
+//
+//   // encodes them into out, and returns the bytes written
+//   size_t svb_encode_delta(uint32_t const* in, size_t n, uint32_t prev, uint8_t* out);
+//
+//   // decodes n values from the len bytes at in
+//   void svb_decode_delta(uint8_t const* in, size_t len, size_t n, uint32_t prev,
+//                         uint32_t* out);
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "simd_level.h"
+
+#ifdef PBBS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace pbbs {
+
+  namespace svb {
+    inline int code(uint32_t x) {
+      return (x < (1u << 8)) ? 0 : (x < (1u << 16)) ? 1 : (x < (1u << 24)) ? 2 : 3;
+    }
+
+    // for each control byte, the bytes of its four values and the
+    // shuffle that moves them to the four 32-bit lanes (0x80 zeros a byte)
+    struct tables {
+      uint8_t length[256];
+      uint8_t shuffle[256][16];
+    };
+
+    inline tables const &get_tables() {
+      static const tables t = [] {
+	tables t;
+	for (int c = 0; c < 256; c++) {
+	  int pos = 0;
+	  for (int j = 0; j < 4; j++) {
+	    int len = ((c >> (2*j)) & 3) + 1;
+	    for (int k = 0; k < 4; k++)
+	      t.shuffle[c][4*j + k] = (k < len) ? pos + k : 0x80;
+	    pos += len;
+	  }
+	  t.length[c] = pos;
+	}
+	return t;
+      }();
+      return t;
+    }
+
+#ifdef PBBS_SIMD_X86
+#pragma GCC push_options
+#pragma GCC target("ssse3")
+    // decodes groups of four while a 16-byte load stays within the data,
+    // and returns the number decoded
+    inline size_t decode_ssse3(uint8_t const* ctrl, uint8_t const* &data,
+			       uint8_t const* end, size_t n, uint32_t &prev,
+			       uint32_t* out) {
+      tables const &t = get_tables();
+      __m128i p = _mm_set1_epi32(prev);
+      size_t i = 0;
+      for (; i + 4 <= n && data + 16 <= end; i += 4) {
+	uint8_t c = ctrl[i/4];
+	__m128i v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const*) data),
+				     _mm_loadu_si128((__m128i const*) t.shuffle[c]));
+	data += t.length[c];
+	// prefix sums of the four differences, plus the previous value
+	v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+	v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+	v = _mm_add_epi32(v, p);
+	_mm_storeu_si128((__m128i*) (out + i), v);
+	p = _mm_shuffle_epi32(v, 0xff);
+      }
+      prev = _mm_cvtsi128_si32(p);
+      return i;
+    }
+#pragma GCC pop_options
+#endif
+  }
+
+  inline size_t svb_delta_bytes(uint32_t const* in, size_t n, uint32_t prev) {
+    size_t bytes = (n + 3) / 4;
+    for (size_t i = 0; i < n; i++) {
+      bytes += svb::code(in[i] - prev) + 1;
+      prev = in[i];
+    }
+    return bytes;
+  }
+
+  inline size_t svb_encode_delta(uint32_t const* in, size_t n, uint32_t prev,
+				 uint8_t* out) {
+    uint8_t* ctrl = out;
+    uint8_t* data = out + (n + 3) / 4;
+    std::memset(ctrl, 0, (n + 3) / 4);
+    for (size_t i = 0; i < n; i++) {
+      uint32_t d = in[i] - prev;
+      prev = in[i];
+      int c = svb::code(d);
+      ctrl[i/4] |= c << (2 * (i % 4));
+      for (int k = 0; k <= c; k++) *data++ = (d >> (8*k)) & 255;
+    }
+    return data - out;
+  }
+
+  inline void svb_decode_delta(uint8_t const* in, size_t len, size_t n,
+			       uint32_t prev, uint32_t* out) {
+    uint8_t const* ctrl = in;
+    uint8_t const* data = in + (n + 3) / 4;
+    size_t i = 0;
+#ifdef PBBS_SIMD_X86
+    if (detected_simd_level() != simd_level::none)
+      i = svb::decode_ssse3(ctrl, data, in + len, n, prev, out);
+#endif
+    for (; i < n; i++) {
+      int c = (ctrl[i/4] >> (2 * (i % 4))) & 3;
+      uint32_t d = 0;
+      for (int k = 0; k <= c; k++) d |= ((uint32_t) *data++) << (8*k);
+      prev += d;
+      out[i] = prev;
+    }
+  }
+}
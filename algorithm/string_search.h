@@ -0,0 +1,129 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Finds every occurrence of a short pattern in a long text, e.g. the
+// separators to split a large input at.
+//
+// The text is cut into blocks that are searched in parallel.  Within a
+// block, 32 positions at a time are filtered by comparing their first
+// and last characters with those of the pattern (with AVX2 when the
+// processor has it), and only the positions that pass are compared in
+// full.  On text where the two characters rarely appear together, as for
+// a separator, this reads each character about once and runs at memory
+// bandwidth.
+//
+// Supports the following interface:
+//
+//   // the sorted start positions of all occurrences of p[0,m) in s[0,n),
+//   // including overlapping ones
+//   parlay::sequence<size_t> find_all(char const* s, size_t n, char const* p, size_t m);
+//
+//   // the same with ranges of characters (e.g. a sequence<char> and a
+//   // std::string_view)
+//   template <class Text, class Pattern>
+//   parlay::sequence<size_t> find_all(Text const &s, Pattern const &p);
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "../parlay/primitives.h"
+#include "../parlay/sequence.h"
+#include "simd_level.h"
+
+#ifdef PBBS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace pbbs {
+
+  namespace string_search {
+
+    // adds to out the occurrences starting in [start, end), for which
+    // the text must extend m-1 characters past end
+    inline void find_scalar(char const* s, size_t start, size_t end,
+			    char const* p, size_t m, parlay::sequence<size_t> &out) {
+      char first = p[0], last = p[m-1];
+      for (size_t i = start; i < end; i++)
+	if (s[i] == first && s[i+m-1] == last &&
+	    std::memcmp(s + i + 1, p + 1, m < 2 ? 0 : m - 2) == 0)
+	  out.push_back(i);
+    }
+
+#ifdef PBBS_SIMD_X86
+#pragma GCC push_options
+#pragma GCC target("avx2,bmi")
+    inline void find_avx2(char const* s, size_t start, size_t end,
+			  char const* p, size_t m, parlay::sequence<size_t> &out) {
+      const __m256i first = _mm256_set1_epi8(p[0]);
+      const __m256i last = _mm256_set1_epi8(p[m-1]);
+      size_t i = start;
+      for (; i + 32 <= end; i += 32) {
+	__m256i a = _mm256_loadu_si256((__m256i const*) (s + i));
+	__m256i b = _mm256_loadu_si256((__m256i const*) (s + i + m - 1));
+	uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+							      _mm256_cmpeq_epi8(b, last)));
+	while (mask != 0) {
+	  size_t j = i + _tzcnt_u32(mask);
+	  if (m < 3 || std::memcmp(s + j + 1, p + 1, m - 2) == 0) out.push_back(j);
+	  mask = _blsr_u32(mask);
+	}
+      }
+      find_scalar(s, i, end, p, m, out);
+    }
+#pragma GCC pop_options
+#endif
+  }
+
+  inline parlay::sequence<size_t> find_all(char const* s, size_t n,
+					   char const* p, size_t m) {
+    if (m == 0 || m > n) return parlay::sequence<size_t>();
+    constexpr size_t block_size = 1 << 16;
+    size_t num_starts = n - m + 1;
+    size_t num_blocks = (num_starts + block_size - 1) / block_size;
+#ifdef PBBS_SIMD_X86
+    bool use_avx2 = detected_simd_level() != simd_level::none;
+#endif
+    auto matches = parlay::tabulate(num_blocks, [&] (size_t b) {
+      size_t start = b * block_size;
+      size_t end = std::min(start + block_size, num_starts);
+      parlay::sequence<size_t> out;
+#ifdef PBBS_SIMD_X86
+      if (use_avx2) {
+	string_search::find_avx2(s, start, end, p, m, out);
+	return out;
+      }
+#endif
+      string_search::find_scalar(s, start, end, p, m, out);
+      return out;
+    }, 1);
+    return parlay::flatten(matches);
+  }
+
+  template <class Text, class Pattern>
+  parlay::sequence<size_t> find_all(Text const &s, Pattern const &p) {
+    if (s.size() == 0 || p.size() == 0) return parlay::sequence<size_t>();
+    return find_all(&s[0], s.size(), &p[0], p.size());
+  }
+}
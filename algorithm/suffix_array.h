@@ -32,6 +32,8 @@
 // Supports the following interface returning a suffix array for c
 //   indexT is the type of integer for the suffix indices
 //   It needs to have at least log_2 n bits.  It can be unsigned.
+//   For texts of 2^32 or more characters it can be 64-bit, or
+//   pbbs::uint40 (see uint40.h) to store the indices in 5 bytes.
 
 //  // indexT is an integer type, either signed or unsigned
 //  // for input of length n, but hold integers up to n+3
@@ -39,9 +41,11 @@
 //  parlay::sequence<indexT> suffix_array(parlay::sequence<unsigned char> const &s);
 
 #include <math.h>
+#include <cstdint>
 #include "../parlay/parallel.h"
 #include "../parlay/primitives.h"
 #include "../parlay/internal/get_time.h"
+#include "../parlay/internal/integer_sort.h"
 
 constexpr bool verbose = false;
 
@@ -112,14 +116,15 @@ template <class indexT>
 parlay::sequence<ipair<indexT>>
 split_segment_top(parlay::sequence<seg<indexT>> &segOut,
 		  parlay::sequence<indexT> &ranks,
-		  parlay::sequence<uint128> const &Cs) {
+		  parlay::sequence<uint128> const &Cs,
+		  size_t loc_bits) {
   size_t n = segOut.size();
   auto names = parlay::sequence<indexT>::uninitialized(n);
-  size_t mask = ((((size_t) 1) << 32) - 1);
+  size_t mask = ((((size_t) 1) << loc_bits) - 1);
 
   // mark start of each segment with equal keys
   parlay::parallel_for (1, n, [&] (size_t i) {
-      names[i] = ((Cs[i] >> 32) != (Cs[i-1] >> 32)) ? i : 0;});
+      names[i] = ((Cs[i] >> loc_bits) != (Cs[i-1] >> loc_bits)) ? i : 0;});
   names[0] = 0;
 
   // scan start i across each segment ???
@@ -143,6 +148,27 @@ split_segment_top(parlay::sequence<seg<indexT>> &segOut,
   return C;
 }
 
+// Packs the first nchars characters of each suffix of ss, renumbered by
+// flags, in base m into a 128-bit word above its location.  charT holds
+// the renumbered characters, so it must hold values up to m-1.
+template <class charT, class indexT, class UCharRange>
+parlay::sequence<uint128> pack_suffixes(UCharRange const &ss,
+					 parlay::sequence<indexT> const &flags,
+					 indexT m, indexT nchars, size_t loc_bits) {
+  size_t n = ss.size();
+
+  // pad the end of string with 0s
+  size_t pad = nchars;
+  auto s = parlay::tabulate(n + pad, [&] (size_t i) -> charT {
+      return (i < n) ? (charT) flags[ss[i]] : 0;});
+
+  return parlay::tabulate(n, [&] (size_t i) -> uint128 {
+      uint128 r = s[i];
+      for (indexT j=1; j < nchars; j++) r = r*m + s[i+j];
+      return (r << loc_bits) + i;
+    });
+}
+
 template <class indexT, class UCharRange>
 parlay::sequence<indexT> suffix_array(UCharRange const &ss) {
   parlay::internal::timer sa_timer("Suffix Array", false);
@@ -150,7 +176,6 @@ parlay::sequence<indexT> suffix_array(UCharRange const &ss) {
 
   // renumber characters densely
   // start numbering at 1 leaving 0 to indicate end-of-string
-  size_t pad = 48;
   parlay::sequence<indexT> flags(256, (indexT) 0);
   parlay::parallel_for (0, n, [&] (size_t i) {
       if (!flags[ss[i]]) flags[ss[i]] = 1;}, 1000);
@@ -158,22 +183,19 @@ parlay::sequence<indexT> suffix_array(UCharRange const &ss) {
   indexT m;
   std::tie(flags, m) = parlay::scan(flags, parlay::make_monoid(add,(indexT) 1));
 
-  // pad the end of string with 0s
-  auto s = parlay::tabulate(n + pad, [&] (size_t i) -> uchar {
-      return (i < n) ? flags[ss[i]] : 0;});
-
   if (verbose) std::cout << "distinct characters = " << m-1 << std::endl;
 
   // pack characters into 128-bit word, along with the location i
-  // 96 bits for characters, and 32 for location
+  // 32 bits for location (more if n >= 2^32), and the rest for characters
+  size_t loc_bits = std::max<size_t>(32, parlay::log2_up(n));
   double logm = log2((double) m);
-  indexT nchars = floor(96.0/logm);
+  indexT nchars = floor((128 - loc_bits)/logm);
 
-  auto Cl = parlay::tabulate(n, [&] (size_t i) -> uint128 {
-      uint128 r = s[i];
-      for (indexT j=1; j < nchars; j++) r = r*m + s[i+j];
-      return (r << 32) + i;
-    });
+  // the new characters go up to m-1, which is 256 only when all byte
+  // values appear, so they are kept in a uchar unless that happens
+  auto Cl = (m <= 256)
+    ? pack_suffixes<uchar>(ss, flags, m, nchars, loc_bits)
+    : pack_suffixes<uint16_t>(ss, flags, m, nchars, loc_bits);
   sa_timer.next("copy into 128bit int");
 
   // sort based on packed words ??
@@ -183,7 +205,7 @@ parlay::sequence<indexT> suffix_array(UCharRange const &ss) {
   // identify segments of equal values
   auto ranks = parlay::sequence<indexT>::uninitialized(n);
   auto seg_outs = parlay::sequence<seg<indexT>>::uninitialized(n); 
-  parlay::sequence<ipair<indexT>> C = split_segment_top(seg_outs, ranks, Cl);
+  parlay::sequence<ipair<indexT>> C = split_segment_top(seg_outs, ranks, Cl, loc_bits);
   Cl.clear();
   sa_timer.next("split top");
 
@@ -215,7 +237,7 @@ parlay::sequence<indexT> suffix_array(UCharRange const &ss) {
 	// grab rank from offset locations ahead
 	parlay::parallel_for (0, l, [&] (size_t j) {
 	    indexT o = Ci[j].second + offset;
-	    Ci[j].first = (o >= n) ? 0 : ranks[o];
+	    Ci[j].first = (o >= n) ? (indexT) 0 : ranks[o];
 	  }, 100);
 
 	// sort within each segment based on ranks
@@ -249,3 +271,196 @@ parlay::sequence<indexT> suffix_array(UCharRange const &ss) {
       ranks[i] = C[i].second;});
   return ranks;
 }
+
+// A memory-lean version of suffix_array, for when the text is large
+// relative to the memory available.
+//
+// The first sort is on 64-bit words holding as many characters as fit
+// above the location i (log_2 n bits), sorted with an integer sort on
+// the character bits only.  This sorts fewer characters than the 96
+// bits of suffix_array, but at 8 rather than 16 bytes per suffix, and
+// the remaining characters are sorted by the doubling rounds, which
+// only touch the suffixes not yet separated.  The pairs C and the ranks
+// are allocated once, the lists of unsorted segments are reused across
+// rounds (growing only when a round needs more), and segments are kept
+// as a compact list rather than one entry per suffix.  Segments are sorted in place, by std::sort if
+// small and by an integer sort on the ranks otherwise.
+//
+// Peak memory is about 17n bytes (for a 4-byte indexT) during the first
+// sort, and 12n bytes plus the unsorted segments afterwards, against
+// over 40n bytes for suffix_array.
+
+namespace lean_internal {
+
+  constexpr size_t seq_threshold = 5000;
+  constexpr size_t block_size = 1 << 14;
+
+  // Replaces each A[i].first by the maximum of A[0,i].first.
+  template <class indexT>
+  void max_scan_first(parlay::slice<ipair<indexT>*,ipair<indexT>*> A) {
+    size_t n = A.size();
+    size_t num_blocks = (n + block_size - 1) / block_size;
+    auto sums = parlay::tabulate(num_blocks, [&] (size_t b) {
+	indexT m = 0;
+	for (size_t i = b * block_size; i < std::min(n, (b+1) * block_size); i++)
+	  m = std::max(m, A[i].first);
+	return m;});
+    parlay::scan_inplace(sums, parlay::maxm<indexT>());
+    parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+      indexT m = sums[b];
+      for (size_t i = b * block_size; i < std::min(n, (b+1) * block_size); i++)
+	A[i].first = m = std::max(m, A[i].first);
+    }, 1);
+  }
+
+  // Segment Cs (at location start in C) is sorted by .first.  Returns the
+  // number of its groups of equal keys with more than one element.
+  template <class indexT>
+  size_t count_groups(parlay::slice<ipair<indexT>*,ipair<indexT>*> Cs) {
+    size_t l = Cs.size();
+    auto is_multi = [&] (size_t j) {
+      return (j == 0 || Cs[j].first != Cs[j-1].first) &&
+	j + 1 < l && Cs[j+1].first == Cs[j].first;};
+    if (l < seq_threshold) {
+      size_t count = 0;
+      for (size_t j = 0; j < l; j++) count += is_multi(j);
+      return count;
+    }
+    return parlay::reduce(parlay::delayed_seq<size_t>(l, is_multi));
+  }
+
+  // Gives each suffix in segment Cs (sorted by .first, at location start
+  // in C) the rank of the start of its group, and writes the groups with
+  // more than one element to out.
+  template <class indexT>
+  void split_groups(parlay::slice<ipair<indexT>*,ipair<indexT>*> Cs,
+		    indexT start, indexT* ranks, seg<indexT>* out) {
+    size_t l = Cs.size();
+    if (l < seq_threshold) {
+      size_t g = 0;
+      for (size_t j = 0; j < l; j++) {
+	if (j > 0 && Cs[j].first != Cs[j-1].first) g = j;
+	ranks[Cs[j].second] = start + g + 1;
+	if ((j + 1 == l || Cs[j+1].first != Cs[j].first) && j > g)
+	  *out++ = seg<indexT>(start + g, j - g + 1);
+      }
+    } else {
+      auto names = parlay::tabulate(l, [&] (size_t j) -> indexT {
+	  return (j == 0 || Cs[j].first != Cs[j-1].first) ? j : 0;});
+      parlay::scan_inclusive_inplace(names, parlay::maxm<indexT>());
+      parlay::parallel_for(0, l, [&] (size_t j) {
+	ranks[Cs[j].second] = start + names[j] + 1;});
+      auto ends = parlay::pack_index<indexT>(parlay::delayed_seq<bool>(l, [&] (size_t j) {
+	    return (j + 1 == l || names[j+1] == j + 1) && names[j] != j;}));
+      parlay::parallel_for(0, ends.size(), [&] (size_t k) {
+	indexT j = ends[k];
+	out[k] = seg<indexT>(start + names[j], j - names[j] + 1);});
+    }
+  }
+}
+
+template <class indexT, class UCharRange>
+parlay::sequence<indexT> suffix_array_lean(UCharRange const &ss) {
+  using namespace lean_internal;
+  parlay::internal::timer sa_timer("Suffix Array", false);
+  size_t n = ss.size();
+  if (n == 0) return parlay::sequence<indexT>();
+
+  // renumber characters densely, leaving 0 for end-of-string
+  parlay::sequence<indexT> flags(256, (indexT) 0);
+  parlay::parallel_for (0, n, [&] (size_t i) {
+      if (!flags[ss[i]]) flags[ss[i]] = 1;}, 1000);
+  auto add = [&] (indexT a, indexT b) {return a + b;};
+  indexT m;
+  std::tie(flags, m) = parlay::scan(flags, parlay::make_monoid(add,(indexT) 1));
+
+  // as many characters as fit in base m above the location bits
+  size_t loc_bits = std::max<size_t>(1, parlay::log2_up(n));
+  size_t char_bits = 64 - loc_bits;
+  size_t nchars = 0;
+  unsigned __int128 range = 1;
+  while ((range * m) <= ((unsigned __int128) 1 << char_bits)) {
+    range *= m; nchars++;}
+  size_t key_bits = std::max<size_t>(1, parlay::log2_up((size_t) range));
+  if (verbose) std::cout << "distinct characters = " << m-1
+			 << ", characters per key = " << nchars << std::endl;
+
+  auto K = parlay::tabulate(n, [&] (size_t i) -> uint64_t {
+      uint64_t r = 0;
+      for (size_t j = 0; j < nchars; j++)
+	r = r * m + ((i + j < n) ? (uint64_t) flags[ss[i+j]] : 0);
+      return (r << loc_bits) + i;
+    });
+  sa_timer.next("pack into 64bit int");
+  parlay::internal::integer_sort_inplace(parlay::make_slice(K), [&] (uint64_t k) {
+      return k >> loc_bits;}, key_bits);
+  sa_timer.next("sort");
+
+  // C holds the suffixes in sorted order, and first the start of each
+  // one's group of equal keys
+  uint64_t mask = (((uint64_t) 1) << loc_bits) - 1;
+  auto C = parlay::tabulate(n, [&] (size_t i) {
+      bool start = (i == 0 || (K[i] >> loc_bits) != (K[i-1] >> loc_bits));
+      return ipair<indexT>(start ? i : 0, K[i] & mask);});
+  K.clear();
+  max_scan_first(C.cut(0, n));
+  auto ranks = parlay::sequence<indexT>::uninitialized(n);
+  parlay::parallel_for (0, n, [&] (size_t i) {ranks[C[i].second] = C[i].first + 1;});
+  auto ends = parlay::pack_index<indexT>(parlay::delayed_seq<bool>(n, [&] (size_t i) {
+	return (i + 1 == n || C[i+1].first == i + 1) && C[i].first != i;}));
+  auto segs = parlay::map(ends, [&] (indexT i) {
+      return seg<indexT>(C[i].first, i - C[i].first + 1);});
+  ends.clear();
+  size_t nSegs = segs.size();
+  parlay::sequence<seg<indexT>> next_segs;
+  auto counts = parlay::sequence<indexT>::uninitialized(nSegs);
+  sa_timer.next("split top");
+
+  size_t rank_bits = parlay::log2_up(n + 1);
+  size_t offset = nchars;
+  uint round = 0;
+  while (nSegs > 0) {
+    if (round++ > 40)
+      throw std::runtime_error("Suffix Array: internal error, too many rounds");
+
+    // sort each segment on the ranks offset locations ahead
+    parlay::parallel_for (0, nSegs, [&] (size_t i) {
+	indexT start = segs[i].start;
+	indexT l = segs[i].length;
+	auto Ci = C.cut(start, start + l);
+	parlay::parallel_for (0, l, [&] (size_t j) {
+	    size_t o = Ci[j].second + offset;
+	    Ci[j].first = (o >= n) ? (indexT) 0 : ranks[o];
+	  }, 100);
+	auto first = [] (ipair<indexT> const &a) {return a.first;};
+	if (l < seq_threshold)
+	  std::sort(Ci.begin(), Ci.end(), [&] (ipair<indexT> const &a, ipair<indexT> const &b) {
+	      return a.first < b.first;});
+	else parlay::internal::integer_sort_inplace(Ci, first, rank_bits);
+	counts[i] = count_groups(Ci);
+      }, 1);
+    sa_timer.next("sort");
+
+    // split them, writing the new segments to next_segs
+    size_t nNext = parlay::scan_inplace(counts.cut(0, nSegs), parlay::addm<indexT>());
+    if (next_segs.size() < nNext)
+      next_segs = parlay::sequence<seg<indexT>>::uninitialized(nNext);
+    parlay::parallel_for (0, nSegs, [&] (size_t i) {
+	indexT start = segs[i].start;
+	split_groups(C.cut(start, start + segs[i].length), start,
+		     ranks.begin(), next_segs.begin() + counts[i]);
+      }, 1);
+    std::swap(segs, next_segs);
+    if (counts.size() < nNext)
+      counts = parlay::sequence<indexT>::uninitialized(nNext);
+    nSegs = nNext;
+    sa_timer.next("split");
+
+    if (verbose)
+      std::cout << "length: " << offset << " segments remaining: " << nSegs << std::endl;
+    offset = 2 * offset;
+  }
+  parlay::parallel_for (0, n, [&] (size_t i) {
+      ranks[i] = C[i].second;});
+  return ranks;
+}
@@ -0,0 +1,301 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Suffix array by induced sorting (SA-IS: Nong, Zhang and Chan, "Two
+// Efficient Algorithms for Linear Time Suffix Array Construction", 2011),
+// with the steps done in parallel.
+//
+// Each suffix is S-type if it is smaller than the next suffix and
+// L-type otherwise, and is LMS if it is S-type and the previous one is
+// L-type.  The LMS suffixes are placed at the ends of the buckets of
+// their first characters, and two induced passes (left to right for the
+// L-type, right to left for the S-type) sort the LMS substrings.  These
+// are named by rank, and the string of names (at most half as long) is
+// solved recursively.  Its suffix array orders the LMS suffixes, and the
+// same two passes induce all the others from them.  The work is O(n).
+//
+// The passes are made parallel as in Labeit, Shun and Blelloch
+// ("Parallel Lightweight Wavelet Tree, Suffix Array and FM-Index
+// Construction", 2017).  A pass moves a scan pointer over the suffix
+// array, and every entry it reads induces at most one entry further
+// on.  All entries between the scan pointer and the first position not
+// yet filled are final, so each step reads that whole range at once,
+// and writes the entries it induces in order with a stable integer sort
+// by bucket.  Ranges smaller than seq_threshold are done sequentially,
+// which covers long runs of one character (e.g. aaaa...), where the
+// range only grows by one at a time.
+//
+// Beyond the input and the output it uses a byte per character for the
+// types, and O(n) words (at most 2n indices) for the reduced string,
+// its suffix array and the LMS positions.
+//
+// Supports the following interface:
+//
+//   // indexT is an unsigned integer type that can hold n
+//   template <class indexT>
+//   parlay::sequence<indexT> suffix_array_sais(parlay::sequence<unsigned char> const &s);
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include "../parlay/parallel.h"
+#include "../parlay/primitives.h"
+#include "../parlay/internal/integer_sort.h"
+
+namespace pbbs {
+
+  namespace sais_internal {
+
+    constexpr size_t seq_threshold = 1 << 14;
+    constexpr size_t block_size = 1 << 16;
+
+    // t[i] is 1 if suffix i is S-type.  Each block sets the types it can
+    // from its own characters, leaving undetermined a final run of
+    // characters equal to the first of the next block, which then gets
+    // the type of that character.
+    template <class Char>
+    parlay::sequence<uint8_t> suffix_types(Char const* s, size_t n) {
+      constexpr uint8_t unknown = 2;
+      auto t = parlay::sequence<uint8_t>::uninitialized(n);
+      size_t num_blocks = (n + block_size - 1) / block_size;
+      parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+	size_t lo = b * block_size;
+	size_t hi = std::min(lo + block_size, n);
+	uint8_t next = (hi == n) ? 0 : unknown;  // the last suffix is L-type
+	for (size_t i = hi; i > lo; i--) {
+	  if (i == n) t[i-1] = 0;
+	  else if (s[i-1] != s[i]) t[i-1] = (s[i-1] < s[i]);
+	  else t[i-1] = next;
+	  next = t[i-1];
+	}
+      }, 1);
+      // the type of the first character of each block
+      auto carry = parlay::sequence<uint8_t>::uninitialized(num_blocks + 1);
+      carry[num_blocks] = 0;
+      for (size_t b = num_blocks; b > 0; b--) {
+	uint8_t first = t[(b-1) * block_size];
+	carry[b-1] = (first == unknown) ? carry[b] : first;
+      }
+      parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+	size_t lo = b * block_size;
+	size_t hi = std::min(lo + block_size, n);
+	for (size_t i = hi; i > lo && t[i-1] == unknown; i--) t[i-1] = carry[b+1];
+      }, 1);
+      return t;
+    }
+
+    // The bucket of character c is SA[starts[c], ends[c]), with its
+    // L-type suffixes first (num_L[c] of them) and then its S-type ones.
+    template <class indexT>
+    struct buckets {
+      parlay::sequence<indexT> starts, ends, num_L;
+      size_t size() const {return starts.size();}
+    };
+
+    template <class indexT, class Char>
+    buckets<indexT> make_buckets(Char const* s, uint8_t const* t, size_t n, size_t K) {
+      auto counts = parlay::histogram_by_index(parlay::make_slice(s, s + n), K);
+      auto L_counts = parlay::histogram_by_index(parlay::delayed_seq<size_t>(n, [&] (size_t i) {
+	    return t[i] ? K : (size_t) s[i];}), K + 1);
+      buckets<indexT> B;
+      B.starts = parlay::map(counts, [] (size_t c) -> indexT {return c;});
+      parlay::scan_inplace(B.starts);
+      B.ends = parlay::tabulate(K, [&] (size_t c) -> indexT {return B.starts[c] + counts[c];});
+      B.num_L = parlay::tabulate(K, [&] (size_t c) -> indexT {return L_counts[c];});
+      return B;
+    }
+
+    // Writes the suffixes P (each with its first character), in order,
+    // at the ends next[c] (for a right to left pass, writing downwards)
+    // or starts next[c] (left to right) of the buckets of their first
+    // characters, and moves next past them.
+    template <class indexT, class Char>
+    void place_in_buckets(parlay::sequence<std::pair<Char, indexT>> const &P, size_t K,
+			  indexT* SA, indexT* next, bool downwards) {
+      size_t bits = std::max<size_t>(1, parlay::log2_up(K));
+      auto sorted = parlay::internal::integer_sort(parlay::make_slice(P), [] (auto const &e) {
+	  return e.first;}, bits);
+      size_t m = sorted.size();
+      auto run_starts = parlay::pack_index<indexT>(parlay::delayed_seq<bool>(m, [&] (size_t k) {
+	    return k == 0 || sorted[k].first != sorted[k-1].first;}));
+      size_t num_runs = run_starts.size();
+      parlay::parallel_for(0, num_runs, [&] (size_t r) {
+	size_t lo = run_starts[r];
+	size_t hi = (r + 1 == num_runs) ? m : run_starts[r+1];
+	Char c = sorted[lo].first;
+	indexT base = next[c];
+	if (downwards) {
+	  parlay::parallel_for(lo, hi, [&] (size_t k) {SA[base - 1 - (k - lo)] = sorted[k].second;});
+	  next[c] = base - (hi - lo);
+	} else {
+	  parlay::parallel_for(lo, hi, [&] (size_t k) {SA[base + (k - lo)] = sorted[k].second;});
+	  next[c] = base + (hi - lo);
+	}
+      }, 1);
+    }
+
+    // the suffixes P with their first characters
+    template <class Seq, class Char>
+    auto with_chars(Seq const &P, Char const* s) {
+      return parlay::map(P, [&] (auto p) {return std::pair(s[p], p);});
+    }
+
+    template <class indexT>
+    constexpr indexT empty = std::numeric_limits<indexT>::max();
+
+    // Left to right pass: each suffix j in the array induces j-1 if that
+    // is L-type.  An L-type part is final up to heads[c], and every
+    // bucket before the first one whose L-type part is not yet full is
+    // final, so the scan can read up to there.
+    template <class indexT, class Char>
+    void induce_L(Char const* s, uint8_t const* t, size_t n,
+		  buckets<indexT> const &B, indexT* SA) {
+      size_t K = B.size();
+      auto heads = B.starts;
+      SA[heads[s[n-1]]++] = n - 1;  // induced by the empty suffix
+      auto induces = [&] (indexT j) {return j != empty<indexT> && j > 0 && !t[j-1];};
+      size_t i = 0, c = 0;
+      while (i < n) {
+	while (c < K && B.ends[c] <= i) c++;
+	size_t d = c;
+	while (d < K && heads[d] == B.starts[d] + B.num_L[d]) d++;
+	size_t e = (d == K) ? n : heads[d];
+	if (e - i < seq_threshold) {
+	  for (size_t k = i; k < e; k++) {
+	    indexT j = SA[k];
+	    if (induces(j)) SA[heads[s[j-1]]++] = j - 1;
+	  }
+	} else {
+	  auto P = parlay::filter(parlay::make_slice(SA + i, SA + e), induces);
+	  auto induced = parlay::map(P, [&] (indexT j) {return std::pair(s[j-1], j-1);});
+	  place_in_buckets(induced, K, SA, heads.begin(), false);
+	}
+	i = e;
+      }
+    }
+
+    // Right to left pass: each suffix j induces j-1 if that is S-type.
+    // An S-type part is final down to tails[c].
+    template <class indexT, class Char>
+    void induce_S(Char const* s, uint8_t const* t, size_t n,
+		  buckets<indexT> const &B, indexT* SA) {
+      size_t K = B.size();
+      auto tails = B.ends;
+      auto induces = [&] (indexT j) {return j != empty<indexT> && j > 0 && t[j-1];};
+      size_t i = n, c = K;
+      while (i > 0) {
+	while (c > 0 && B.starts[c-1] >= i) c--;
+	size_t d = c;
+	while (d > 0 && tails[d-1] == B.starts[d-1] + B.num_L[d-1]) d--;
+	size_t e = (d == 0) ? 0 : tails[d-1];
+	if (i - e < seq_threshold) {
+	  for (size_t k = i; k > e; k--) {
+	    indexT j = SA[k-1];
+	    if (induces(j)) SA[--tails[s[j-1]]] = j - 1;
+	  }
+	} else {
+	  auto P = parlay::filter(parlay::delayed_seq<indexT>(i - e, [&] (size_t k) {
+		return SA[i - 1 - k];}), induces);
+	  auto induced = parlay::map(P, [&] (indexT j) {return std::pair(s[j-1], j-1);});
+	  place_in_buckets(induced, K, SA, tails.begin(), true);
+	}
+	i = e;
+      }
+    }
+
+    // Sorts the suffixes of s[0,n), with characters in [0,K), into SA.
+    template <class indexT, class Char>
+    void sais(Char const* s, size_t n, size_t K, indexT* SA) {
+      if (n == 0) return;
+      auto types = suffix_types(s, n);
+      uint8_t const* t = types.begin();
+      auto is_lms = [&] (size_t i) {return i > 0 && t[i] && !t[i-1];};
+      auto B = make_buckets<indexT>(s, t, n, K);
+
+      // sort the LMS substrings, starting from the LMS suffixes in any
+      // order within their buckets
+      auto lms = parlay::pack_index<indexT>(parlay::delayed_seq<bool>(n, is_lms));
+      size_t n1 = lms.size();
+      parlay::parallel_for(0, n, [&] (size_t i) {SA[i] = empty<indexT>;});
+      auto tails = B.ends;
+      place_in_buckets(with_chars(lms, s), K, SA, tails.begin(), true);
+      induce_L(s, t, n, B, SA);
+      induce_S(s, t, n, B, SA);
+
+      // name the LMS substrings by rank, with equal ones getting equal
+      // names.  LMS positions are at least two apart, so the length of
+      // the substring at p can be kept at p/2, and then its name.
+      auto sorted_lms = parlay::filter(parlay::make_slice(SA, SA + n), [&] (indexT j) {
+	  return is_lms(j);});
+      auto name = parlay::sequence<indexT>::uninitialized(n / 2 + 1);
+      parlay::parallel_for(0, n1, [&] (size_t k) {
+	size_t next = (k + 1 == n1) ? n : lms[k+1];
+	name[lms[k] / 2] = next - lms[k] + 1;  // past n includes the sentinel
+      });
+      auto equal = [&] (size_t a, size_t b) {
+	size_t len = name[a / 2];
+	if (name[b / 2] != len || a + len > n || b + len > n) return false;
+	for (size_t i = 0; i < len; i++)
+	  if (s[a + i] != s[b + i]) return false;
+	return true;
+      };
+      auto new_name = parlay::tabulate(n1, [&] (size_t k) -> indexT {
+	  return (k == 0 || !equal(sorted_lms[k-1], sorted_lms[k])) ? 1 : 0;});
+      parlay::scan_inclusive_inplace(new_name, parlay::addm<indexT>());
+      size_t K1 = (n1 == 0) ? 0 : new_name[n1-1];
+      parlay::parallel_for(0, n1, [&] (size_t k) {
+	name[sorted_lms[k] / 2] = new_name[k] - 1;});
+      new_name.clear();
+      auto s1 = parlay::tabulate(n1, [&] (size_t r) -> indexT {return name[lms[r] / 2];});
+      name.clear();
+
+      // the suffix array of the string of names orders the LMS suffixes,
+      // which are kept in reverse order since they are written to the
+      // buckets downwards
+      auto SA1 = parlay::sequence<indexT>::uninitialized(n1);
+      if (K1 == n1) parlay::parallel_for(0, n1, [&] (size_t r) {SA1[s1[r]] = r;});
+      else sais(s1.begin(), n1, K1, SA1.begin());
+      s1.clear();
+      parlay::parallel_for(0, n1, [&] (size_t k) {sorted_lms[k] = lms[SA1[n1 - 1 - k]];});
+      SA1.clear();
+      lms.clear();
+
+      // induce all suffixes from the sorted LMS suffixes
+      parlay::parallel_for(0, n, [&] (size_t i) {SA[i] = empty<indexT>;});
+      tails = B.ends;
+      place_in_buckets(with_chars(sorted_lms, s), K, SA, tails.begin(), true);
+      induce_L(s, t, n, B, SA);
+      induce_S(s, t, n, B, SA);
+    }
+  }
+
+  template <class indexT>
+  parlay::sequence<indexT> suffix_array_sais(parlay::sequence<unsigned char> const &s) {
+    size_t n = s.size();
+    auto SA = parlay::sequence<indexT>::uninitialized(n);
+    sais_internal::sais(s.begin(), n, 256, SA.begin());
+    return SA;
+  }
+}
@@ -0,0 +1,82 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// A 40-bit unsigned integer stored in 5 bytes, for index arrays over
+// texts too long for 32-bit indices, where 64-bit indices would cost
+// 8 bytes each.  It holds values below 2^40 (about 10^12).
+//
+// Supports the following interface:
+//
+//   // implicit conversions to and from uint64_t, so arithmetic and
+//   // comparisons are done on uint64_t values
+//   uint40 x = (uint64_t) v;  uint64_t v = x;
+//   ++x, x++, --x, x--, x += v, x -= v
+//
+// std::numeric_limits is specialized, so it can be used with
+// parlay::addm, parlay::maxm and parlay::minm.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace pbbs {
+
+  struct uint40 {
+    uint8_t bytes[5];
+
+    uint40() = default;
+    uint40(uint64_t v) {
+      uint32_t low = (uint32_t) v;
+      std::memcpy(bytes, &low, 4);
+      bytes[4] = (uint8_t) (v >> 32);
+    }
+    operator uint64_t() const {
+      uint32_t low;
+      std::memcpy(&low, bytes, 4);
+      return low | ((uint64_t) bytes[4] << 32);
+    }
+
+    uint40& operator+=(uint64_t v) {return *this = *this + v;}
+    uint40& operator-=(uint64_t v) {return *this = *this - v;}
+    uint40& operator++() {return *this += 1;}
+    uint40& operator--() {return *this -= 1;}
+    uint40 operator++(int) {uint40 r = *this; ++*this; return r;}
+    uint40 operator--(int) {uint40 r = *this; --*this; return r;}
+  };
+
+  static_assert(sizeof(uint40) == 5, "uint40 should be packed into 5 bytes");
+}
+
+namespace std {
+  template <>
+  struct numeric_limits<pbbs::uint40> {
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = false;
+    static constexpr bool is_integer = true;
+    static constexpr int digits = 40;
+    static pbbs::uint40 min() {return pbbs::uint40(0);}
+    static pbbs::uint40 lowest() {return pbbs::uint40(0);}
+    static pbbs::uint40 max() {return pbbs::uint40((((uint64_t) 1) << 40) - 1);}
+  };
+}
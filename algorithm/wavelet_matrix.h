@@ -0,0 +1,204 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011-2019 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// A wavelet matrix (Claude, Navarro and Ordonez, "The wavelet matrix",
+// 2015) over a sequence of small integer codes, supporting access and
+// rank, on top of bit vectors with constant time rank.
+//
+// A code of b bits is split over b levels, one bit per level starting
+// from the highest.  Level l holds the l-th bit of every code, in the
+// order left by a stable partition of the previous level by its bit
+// (zeros first).  Tracking a position down the levels takes one rank
+// per level.
+//
+// The bit vectors interleave their rank counts with their bits: each
+// 64-byte block holds the number of ones before it and the next 448
+// bits, so a rank reads one cache line.
+//
+//   rank_bitvector B(n, f);  // bit i is f(i), for i < n
+//   B[i]                     // bit i
+//   B.rank1(i), B.rank0(i)   // number of ones (zeros) in [0, i)
+//   B.access_rank1(i)        // the pair B[i], B.rank1(i)
+//
+//   wavelet_matrix W(A, b);  // A a sequence of codes of at most b bits
+//   W[i]                     // A[i]
+//   W.rank(c, i)             // occurrences of c in A[0, i)
+//   W.rank(c, i, j)          // the pair rank(c, i), rank(c, j)
+//   W.inverse_select(i)      // the pair A[i], rank(A[i], i)
+//   W.size_in_bytes()
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "../parlay/parallel.h"
+#include "../parlay/primitives.h"
+
+namespace pbbs {
+
+  class rank_bitvector {
+    struct alignas(64) block {
+      uint64_t count;     // ones before this block
+      uint64_t words[7];  // the next 448 bits
+    };
+    static constexpr size_t block_bits = 448;
+    size_t n = 0;
+    parlay::sequence<block> blocks;
+
+  public:
+    rank_bitvector() {}
+
+    template <class F>
+    rank_bitvector(size_t n, F f) : n(n) {
+      // an extra block so that rank1(n) is defined
+      size_t num_blocks = n / block_bits + 1;
+      blocks = parlay::tabulate(num_blocks, [&] (size_t b) {
+	block B;
+	size_t start = b * block_bits;
+	for (size_t w = 0; w < 7; w++) {
+	  uint64_t word = 0;
+	  size_t lo = start + 64 * w;
+	  for (size_t i = lo; i < std::min(n, lo + 64); i++)
+	    word |= ((uint64_t) f(i)) << (i - lo);
+	  B.words[w] = word;
+	}
+	B.count = 0;
+	for (size_t w = 0; w < 7; w++) B.count += __builtin_popcountll(B.words[w]);
+	return B;});
+      // the counts of the blocks so far are their own, so scan them
+      auto counts = parlay::scan(parlay::delayed_map(blocks, [] (block const &B) {
+	    return B.count;})).first;
+      parlay::parallel_for(0, num_blocks, [&] (size_t b) {blocks[b].count = counts[b];});
+    }
+
+    size_t size() const {return n;}
+
+    bool operator[](size_t i) const {
+      block const &B = blocks[i / block_bits];
+      size_t r = i % block_bits;
+      return (B.words[r / 64] >> (r % 64)) & 1;
+    }
+
+    size_t rank1(size_t i) const {
+      block const &B = blocks[i / block_bits];
+      size_t r = i % block_bits;
+      size_t count = B.count;
+      size_t w = r / 64;
+      for (size_t k = 0; k < w; k++) count += __builtin_popcountll(B.words[k]);
+      if (r % 64) count += __builtin_popcountll(B.words[w] & ((((uint64_t) 1) << (r % 64)) - 1));
+      return count;
+    }
+
+    size_t rank0(size_t i) const {return i - rank1(i);}
+
+    // bit i and rank1(i), reading the block once
+    std::pair<bool,size_t> access_rank1(size_t i) const {
+      block const &B = blocks[i / block_bits];
+      size_t r = i % block_bits;
+      size_t count = B.count;
+      size_t w = r / 64;
+      for (size_t k = 0; k < w; k++) count += __builtin_popcountll(B.words[k]);
+      uint64_t word = B.words[w];
+      count += __builtin_popcountll(word & ((((uint64_t) 1) << (r % 64)) - 1));
+      return std::make_pair((bool) ((word >> (r % 64)) & 1), count);
+    }
+
+    size_t size_in_bytes() const {return blocks.size() * sizeof(block);}
+  };
+
+  class wavelet_matrix {
+    size_t n = 0;
+    size_t levels = 0;
+    parlay::sequence<rank_bitvector> bits;
+    parlay::sequence<size_t> zeros;   // number of zeros on each level
+    parlay::sequence<size_t> starts;  // where each code ends up below the last level
+
+    // position i on level l moves to this position on level l+1
+    size_t down(size_t l, size_t i, bool bit) const {
+      return bit ? zeros[l] + bits[l].rank1(i) : bits[l].rank0(i);}
+
+  public:
+    wavelet_matrix() {}
+
+    template <class Seq>
+    wavelet_matrix(Seq const &A, size_t levels) : n(A.size()), levels(levels) {
+      using T = typename Seq::value_type;
+      auto cur = parlay::to_sequence(A);
+      bits = parlay::sequence<rank_bitvector>(levels);
+      zeros = parlay::sequence<size_t>(levels);
+      for (size_t l = 0; l < levels; l++) {
+	size_t shift = levels - 1 - l;
+	auto bit = [shift] (T c) -> bool {return (c >> shift) & 1;};
+	bits[l] = rank_bitvector(n, [&] (size_t i) {return bit(cur[i]);});
+	zeros[l] = bits[l].rank0(n);
+	if (l + 1 < levels) {
+	  auto ones = parlay::filter(cur, bit);
+	  auto next = parlay::filter(cur, [&] (T c) {return !bit(c);});
+	  next.append(ones);
+	  cur = std::move(next);
+	}
+      }
+      starts = parlay::tabulate(((size_t) 1) << levels, [&] (size_t c) {
+	size_t p = 0;
+	for (size_t l = 0; l < levels; l++)
+	  p = down(l, p, (c >> (levels - 1 - l)) & 1);
+	return p;});
+    }
+
+    size_t size() const {return n;}
+
+    size_t operator[](size_t i) const {return inverse_select(i).first;}
+
+    size_t rank(size_t c, size_t i) const {
+      for (size_t l = 0; l < levels; l++)
+	i = down(l, i, (c >> (levels - 1 - l)) & 1);
+      return i - starts[c];
+    }
+
+    // both ranks in one pass, e.g. for the two ends of a range
+    std::pair<size_t,size_t> rank(size_t c, size_t i, size_t j) const {
+      for (size_t l = 0; l < levels; l++) {
+	bool b = (c >> (levels - 1 - l)) & 1;
+	i = down(l, i, b);
+	j = down(l, j, b);
+      }
+      return std::make_pair(i - starts[c], j - starts[c]);
+    }
+
+    std::pair<size_t,size_t> inverse_select(size_t i) const {
+      size_t c = 0;
+      for (size_t l = 0; l < levels; l++) {
+	auto [b, ones] = bits[l].access_rank1(i);
+	c = 2 * c + b;
+	i = b ? zeros[l] + ones : i - ones;
+      }
+      return std::make_pair(c, i - starts[c]);
+    }
+
+    size_t size_in_bytes() const {
+      size_t total = 0;
+      for (size_t l = 0; l < levels; l++) total += bits[l].size_in_bytes();
+      return total;
+    }
+  };
+}
@@ -0,0 +1,11 @@
+#include "parlay/primitives.h"
+
+using uchar = unsigned char;
+using ucharseq = parlay::sequence<uchar>;
+
+// compresses s in independent blocks of block_size characters
+// (block_size < 2^32)
+ucharseq bw_compress(ucharseq const &s, size_t block_size);
+
+// the inverse of bw_compress
+ucharseq bw_decompress(ucharseq const &c);
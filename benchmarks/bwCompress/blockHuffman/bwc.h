@@ -0,0 +1 @@
+../bench/bwc.h
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cmath>
+#include "parlay/primitives.h"
+#include "parlay/random.h"
+#include "parlay/internal/counting_sort.h"
+#include "algorithm/simd_sort.h"
+
+constexpr bool INPLACE = false;
+
+// A sample sort whose buckets are finished by the vectorized sort in
+// algorithm/simd_sort.h when the keys are int, float or double compared
+// with std::less.  Any other type or comparison uses std::sort on the
+// buckets, so the interface is the same as for the other sorts.
+
+template <class T, class BinPred>
+void sort_bucket(parlay::slice<T*,T*> A, const BinPred& f) {
+  if constexpr (pbbs::simd_sortable<T> && std::is_same<BinPred, std::less<T>>::value) {
+    auto Tmp = parlay::sequence<T>::uninitialized(A.size());
+    pbbs::simd_sort(A.begin(), Tmp.begin(), A.size());
+  } else std::sort(A.begin(), A.end(), f);
+}
+
+template <class Range, class BinPred>
+auto simd_sample_sort(Range A, const BinPred& f) {
+  using T = typename Range::value_type;
+  size_t n = A.size();
+  size_t base_case_size = 16384;
+  if (n <= base_case_size) {
+    auto R = parlay::to_sequence(A);
+    sort_bucket(parlay::make_slice(R), f);
+    return R;
+  }
+
+  // pick about sqrt(n) pivots from a sorted random sample
+  size_t over_sample = 8;
+  size_t num_pivots = (size_t) std::sqrt((double) n) / 2;
+  parlay::random r(n);
+  auto sample = parlay::sort(parlay::tabulate(num_pivots * over_sample, [&] (size_t i) {
+	return A[r.ith_rand(i) % n];}), f);
+  auto pivots = parlay::tabulate(num_pivots, [&] (size_t i) {
+      return sample[i * over_sample + over_sample/2];});
+
+  // bucket 2i holds the keys strictly between pivots i-1 and i, and bucket
+  // 2i+1 the keys equal to pivot i, so repeated keys end up in buckets that
+  // need no sorting
+  auto bucket_ids = parlay::tabulate(n, [&] (size_t i) -> unsigned int {
+      size_t j = std::lower_bound(pivots.begin(), pivots.end(), A[i], f) - pivots.begin();
+      return (j < num_pivots && !f(A[i], pivots[j])) ? 2*j+1 : 2*j;});
+  size_t num_buckets = 2*num_pivots + 1;
+  auto sorted = parlay::internal::count_sort(A, bucket_ids, num_buckets);
+  parlay::sequence<T> R = std::move(sorted.first);
+  auto offsets = std::move(sorted.second);
+
+  parlay::parallel_for(0, num_buckets/2 + 1, [&] (size_t i) {
+      size_t start = offsets[2*i];
+      size_t end = offsets[2*i+1];
+      if (end - start > std::max(base_case_size, 16 * n / num_buckets)) {
+	// a badly sampled bucket, recurse on it in parallel
+	auto S = simd_sample_sort(R.cut(start, end), f);
+	parlay::parallel_for(0, S.size(), [&] (size_t j) {R[start+j] = S[j];});
+      } else sort_bucket(R.cut(start, end), f);
+    }, 1);
+  return R;
+}
+
+template <class T, class BinPred>
+parlay::sequence<T> compSort(parlay::sequence<T> const &A, const BinPred& f) {
+  return simd_sample_sort(parlay::make_slice(A), f);
+}
@@ -0,0 +1,7 @@
+#include "parlay/primitives.h"
+
+// exact count, for comparison (ignores bits)
+template <class T>
+size_t distinct_count(parlay::sequence<T> const &A, int bits) {
+  return parlay::remove_duplicates(A).size();
+}
@@ -0,0 +1,11 @@
+#include "parlay/primitives.h"
+#include "algorithm/hash_set.h"
+#include "algorithm/hyperloglog.h"
+
+// estimate from a sketch with 2^bits registers
+template <class T>
+size_t distinct_count(parlay::sequence<T> const &A, int bits) {
+  auto S = pbbs::build_hyperloglog(A.size(), [&] (size_t i) {
+      return pbbs::hash_value(A[i]);}, bits);
+  return (size_t) std::round(S.estimate());
+}
@@ -0,0 +1 @@
+../bench/extSort.h
\ No newline at end of file
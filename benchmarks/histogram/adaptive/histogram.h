@@ -0,0 +1 @@
+../bench/histogram.h
\ No newline at end of file
@@ -1,3 +1,5 @@
 #include "parlay/primitives.h"
 
-parlay::sequence<uint> histogram(parlay::sequence<uint> const &In, uint buckets);
+// in verbose mode implementations may report how they counted
+parlay::sequence<uint> histogram(parlay::sequence<uint> const &In, uint buckets,
+				 bool verbose = false);
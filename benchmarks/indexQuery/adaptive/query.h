@@ -0,0 +1 @@
+../bench/query.h
\ No newline at end of file
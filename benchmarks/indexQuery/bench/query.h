@@ -0,0 +1,24 @@
+#include "parlay/primitives.h"
+#include "parlay/utilities.h"
+#include "algorithm/posting_lists.h"
+
+using charseq = parlay::sequence<char>;
+
+// A query asks for the documents that contain all of its terms
+// (conjunctive) or any of them.
+struct query {
+  bool conjunctive;
+  parlay::sequence<std::string_view> terms;
+};
+
+// returns the sorted ids of the documents in the index that match q
+parlay::sequence<uint32_t> answer_query(pbbs::posting_lists const &index,
+					query const &q);
+
+// the output has a line per query with its size and this checksum,
+// which does not depend on the order of the ids
+inline uint64_t result_checksum(parlay::sequence<uint32_t> const &ids) {
+  uint64_t sum = 0;
+  for (uint32_t id : ids) sum += parlay::hash64(id);
+  return sum;
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <string_view>
+#include "parlay/primitives.h"
+#include "algorithm/document_words.h"
+
+using charseq = parlay::sequence<char>;
+
+// An inverted index that documents are added to in batches.  Documents
+// get ids in the order they are added, from 0, and their words are the
+// maximal runs of letters, in lower case, as in invertedIndex.
+//
+// The words are kept sorted, each with the sorted ids of its documents.
+// A batch is tokenized and grouped by word, and then merged with the
+// index word by word.  The new ids are all larger than the old ones, so
+// the list of a word already in the index is extended in place, and
+// since each word of the batch is distinct this is done in parallel.
+// Words new to the index are merged into the sorted words by moving
+// the entries, without copying their lists.  A batch therefore costs
+// time in its size plus the number of distinct words, but not in the
+// number of postings already in the index.
+class inverted_index {
+  using entry = pbbs::word_docs;
+  parlay::sequence<entry> entries;
+  size_t num_docs = 0;
+
+  static bool less(entry const &a, entry const &b) {return a.first < b.first;}
+
+public:
+  size_t size() const {return entries.size();}
+  size_t num_documents() const {return num_docs;}
+
+  // docs[j] is the text of document num_documents() + j
+  template <class Docs>
+  void add_documents(Docs const &docs) {
+    auto batch = pbbs::group_document_words(docs, num_docs);
+    num_docs += docs.size();
+    size_t n = entries.size();
+
+    // where each word of the batch is, or would go, in the index
+    auto pos = parlay::map(batch, [&] (entry const &e) -> size_t {
+	return std::lower_bound(entries.begin(), entries.end(), e, less) - entries.begin();});
+    auto is_new = parlay::tabulate(batch.size(), [&] (size_t i) -> bool {
+	return pos[i] == n || entries[pos[i]].first != batch[i].first;});
+
+    parlay::parallel_for(0, batch.size(), [&] (size_t i) {
+      if (!is_new[i]) entries[pos[i]].second.append(batch[i].second);});
+
+    auto new_words = parlay::pack_index(is_new);
+    size_t m = new_words.size();
+    if (m == 0) return;
+
+    // new word k goes to pos + k, and old entry j moves up by the number
+    // of new words that go before it
+    parlay::sequence<entry> merged(n + m);
+    parlay::parallel_for(0, m, [&] (size_t k) {
+      size_t i = new_words[k];
+      merged[pos[i] + k] = std::move(batch[i]);
+      size_t start = (k == 0) ? 0 : pos[new_words[k-1]];
+      parlay::parallel_for(start, pos[i], [&] (size_t j) {
+	merged[j + k] = std::move(entries[j]);});
+    });
+    parlay::parallel_for(pos[new_words[m-1]], n, [&] (size_t j) {
+      merged[j + m] = std::move(entries[j]);});
+    entries = std::move(merged);
+  }
+
+  // the index in the output format of invertedIndex: a line per word with
+  // the word followed by its document ids
+  charseq to_text() const {
+    auto docstr = parlay::tabulate(num_docs, [] (size_t i) {
+	return parlay::to_chars(i);});
+    auto lines = parlay::map(entries, [&] (entry const &e) {
+	size_t len = e.first.size() + 1;
+	for (auto d : e.second) len += docstr[d].size() + 1;
+	auto line = charseq::uninitialized(len);
+	char* p = std::copy(e.first.begin(), e.first.end(), line.begin());
+	for (auto d : e.second) {
+	  *p++ = ' ';
+	  p = std::copy(docstr[d].begin(), docstr[d].end(), p);
+	}
+	*p = '\n';
+	return line;});
+    return parlay::flatten(lines);
+  }
+};
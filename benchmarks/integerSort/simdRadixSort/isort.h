@@ -0,0 +1,61 @@
+#include "parlay/primitives.h"
+#include "algorithm/simd_histogram.h"
+
+// LSD radix sort on 8-bit digits.  Each pass counts the digits of every
+// block with the sub-histogram kernel, scans the counts in digit-major
+// order, and then moves each block stably into the other buffer.
+template <class T, class Key>
+parlay::sequence<T> simd_radix_sort(parlay::slice<T*,T*> In, Key key, size_t bits) {
+  constexpr int digit_bits = 8;
+  constexpr size_t num_digits = ((size_t) 1) << digit_bits;
+  size_t n = In.size();
+  if (bits == 0) {
+    uint max_key = parlay::reduce(parlay::delayed_map(In, key), parlay::maxm<uint>());
+    while (bits < 32 && (max_key >> bits) > 0) bits++;
+  }
+  bits = std::min<size_t>(bits, 32);
+  auto A = parlay::to_sequence(In);
+  if (n == 0 || bits == 0) return A;
+  auto B = parlay::sequence<T>::uninitialized(n);
+  size_t block_size = std::max<size_t>(1 << 14, n / (8 * parlay::num_workers()) + 1);
+  size_t num_blocks = (n + block_size - 1) / block_size;
+  // counts[d*num_blocks + b] is the number of keys with digit d in block b
+  auto counts = parlay::sequence<size_t>::uninitialized(num_digits * num_blocks);
+  T* src = A.begin();
+  T* dst = B.begin();
+  for (size_t shift = 0; shift < bits; shift += digit_bits) {
+    int b_bits = std::min<int>(digit_bits, bits - shift);
+    size_t mask = (((size_t) 1) << b_bits) - 1;
+    parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+      size_t start = b * block_size;
+      size_t len = std::min(n, start + block_size) - start;
+      uint32_t c[num_digits] = {};
+      if constexpr (pbbs::has_key32<T>::value)
+	pbbs::digit_histogram(src + start, len, shift, b_bits, c);
+      else pbbs::digit_histogram(src + start, len, key, shift, b_bits, c);
+      for (size_t d = 0; d < num_digits; d++) counts[d * num_blocks + b] = c[d];
+    }, 1);
+    parlay::scan_inplace(counts);
+    parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+      size_t o[num_digits];
+      for (size_t d = 0; d < num_digits; d++) o[d] = counts[d * num_blocks + b];
+      for (size_t i = b * block_size; i < std::min(n, (b+1) * block_size); i++)
+	dst[o[(key(src[i]) >> shift) & mask]++] = src[i];
+    }, 1);
+    std::swap(src, dst);
+  }
+  if (src == A.begin()) return A;
+  return B;
+}
+
+template <class T>
+auto int_sort(parlay::slice<T*,T*> In, size_t bits) {
+  auto f = [] (T x) {return (uint) x;};
+  return simd_radix_sort(In, f, bits);
+}
+
+template <class E, class F>
+auto int_sort(parlay::slice<std::pair<E,F>*, std::pair<E,F>*> In, size_t bits) {
+  auto f = [] (std::pair<E,F> const &x) {return (uint) x.first;};
+  return simd_radix_sort(In, f, bits);
+}
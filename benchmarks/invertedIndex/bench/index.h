@@ -2,7 +2,7 @@
 
 using charseq = parlay::sequence<char>;
 
+// returns the index as text, or if binary is set in the binary format of
+// algorithm/posting_lists.h
 charseq build_index(charseq const &s, charseq const &doc_start,
-		    bool verbose);
-
-
+		    bool verbose, bool binary = false);
@@ -0,0 +1 @@
+../bench/index.h
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "parlay/primitives.h"
+
+using charseq = parlay::sequence<unsigned char>;
+
+// an occurrence of a substring: the document, and the start of the
+// substring in it, counting from the first character after the start
+// string
+using occurrence = std::pair<size_t,size_t>;
+
+// Documents are the parts of s that begin with doc_start (which is not
+// part of them).  Returns
+//  1) the length of the longest substring that occurs in at least k
+//     documents
+//  2) an occurrence of it in each of k distinct documents, in order
+//     of document (empty if there are fewer than k documents)
+using result_type = std::pair<size_t, parlay::sequence<occurrence>>;
+
+result_type lcs(charseq const &s, charseq const &doc_start, size_t k);
@@ -0,0 +1 @@
+../bench/lcs.h
\ No newline at end of file
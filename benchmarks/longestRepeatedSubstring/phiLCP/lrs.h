@@ -0,0 +1 @@
+../bench/lrs.h
\ No newline at end of file
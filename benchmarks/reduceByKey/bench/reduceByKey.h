@@ -0,0 +1,13 @@
+#include "parlay/primitives.h"
+
+using uint_pair = std::pair<uint,uint>;
+using long_pair = std::pair<long,long>;
+using double_pair = std::pair<double,double>;
+
+// For each distinct key (first element) returns the key and the sum of
+// the weights (second elements) that go with it, in any order.
+// Integer weights are summed as longs.
+parlay::sequence<long_pair> sum_by_key(parlay::sequence<uint_pair> const &In,
+				       bool verbose = false);
+parlay::sequence<double_pair> sum_by_key(parlay::sequence<double_pair> const &In,
+					 bool verbose = false);
@@ -0,0 +1 @@
+../bench/reduceByKey.h
\ No newline at end of file
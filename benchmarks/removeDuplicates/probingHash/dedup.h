@@ -0,0 +1,73 @@
+#include <atomic>
+#include <cstring>
+#include "parlay/primitives.h"
+#include "algorithm/hash_set.h"
+#include "algorithm/hyperloglog.h"
+
+// Inserts positions 0..n-1 of Keys into a lock-free linear probing table
+// sized from an estimate of the number of distinct keys, then packs the
+// occupied slots.  If the estimate was too low and the table passes 3/4
+// full, the insertions are redone in a table with room for all n.
+template <class Seq, class Hash, class Equal>
+parlay::sequence<size_t> distinct_positions(Seq const &Keys, Hash hash, Equal equal,
+					    size_t estimate) {
+  constexpr size_t block_size = 2048;
+  constexpr double load_factor = 0.5;
+  size_t n = Keys.size();
+  size_t num_blocks = (n + block_size - 1) / block_size;
+
+  // at least room for the inserts in flight when an overflow is noticed
+  size_t min_size = 4 * block_size * parlay::num_workers();
+  size_t capacity = std::max(min_size, (size_t) (estimate / load_factor));
+  while (true) {
+    pbbs::index_hash_set<Seq, Hash, Equal> S(Keys, capacity, hash, equal);
+    size_t limit = 3 * S.capacity() / 4;
+    std::atomic<size_t> count(0);
+    std::atomic<bool> overflow(false);
+    parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+      if (overflow) return;
+      size_t added = 0;
+      for (size_t i = b * block_size; i < std::min(n, (b+1) * block_size); i++)
+	added += S.insert(i);
+      if (count.fetch_add(added) + added > limit) overflow = true;
+    }, 1);
+    if (!overflow) return S.entries();
+    capacity = std::max(capacity, (size_t) (n / load_factor));
+  }
+}
+
+template <class T>
+parlay::sequence<T> dedup(parlay::sequence<T> const &A) {
+  auto hash = [] (T const &a) {return pbbs::hash_value(a);};
+  auto equal = [] (T const &a, T const &b) {return a == b;};
+  size_t estimate = pbbs::estimate_distinct(A.size(), [&] (size_t i) {
+      return hash(A[i]);});
+  return parlay::map(distinct_positions(A, hash, equal, estimate),
+		     [&] (size_t i) {return A[i];});
+}
+
+// Strings are first packed into one character arena, with offsets, and
+// hashed once in parallel.  The table then works on positions, comparing
+// the full 64-bit hashes and only reading characters when those match.
+inline parlay::sequence<parlay::sequence<char>>
+dedup(parlay::sequence<parlay::sequence<char>> const &A) {
+  size_t n = A.size();
+  if (n == 0) return parlay::sequence<parlay::sequence<char>>();
+  auto lengths = parlay::map(A, [] (parlay::sequence<char> const &s) {return s.size();});
+  auto offsets = parlay::scan(lengths).first;
+  auto chars = parlay::sequence<char>::uninitialized(offsets[n-1] + lengths[n-1]);
+  parlay::parallel_for(0, n, [&] (size_t i) {
+    std::memcpy(chars.begin() + offsets[i], A[i].begin(), lengths[i]);});
+  auto hashes = parlay::tabulate(n, [&] (size_t i) {
+    return pbbs::hash_bytes(chars.begin() + offsets[i], lengths[i]);});
+
+  auto positions = parlay::iota(n);
+  auto hash = [&] (size_t i) {return hashes[i];};
+  auto equal = [&] (size_t i, size_t j) {
+    return (hashes[i] == hashes[j] && lengths[i] == lengths[j] &&
+	    std::memcmp(chars.begin() + offsets[i], chars.begin() + offsets[j],
+			lengths[i]) == 0);};
+  size_t estimate = pbbs::estimate_distinct(n, hash);
+  return parlay::map(distinct_positions(positions, hash, equal, estimate),
+		     [&] (size_t i) {return A[i];});
+}
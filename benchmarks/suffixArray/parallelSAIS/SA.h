@@ -0,0 +1 @@
+../bench/SA.h
\ No newline at end of file
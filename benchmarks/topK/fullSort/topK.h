@@ -0,0 +1,8 @@
+#include "parlay/primitives.h"
+
+// Baseline: sorts everything and keeps the first k.
+template <class T, class BinPred>
+parlay::sequence<T> topK(parlay::sequence<T> const &A, size_t k, const BinPred& less) {
+  auto sorted = parlay::sort(A, less);
+  return parlay::to_sequence(sorted.cut(0, std::min(k, sorted.size())));
+}
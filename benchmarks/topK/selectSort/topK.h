@@ -0,0 +1,19 @@
+#include "parlay/primitives.h"
+#include "algorithm/kth_smallest.h"
+
+// Selects the k-th smallest, keeps the elements up to it, and sorts only
+// those.  Ties with the k-th smallest are filled in from the input.
+template <class T, class BinPred>
+parlay::sequence<T> topK(parlay::sequence<T> const &A, size_t k, const BinPred& less) {
+  size_t n = A.size();
+  if (k == 0) return parlay::sequence<T>();
+  if (k >= n) return parlay::sort(A, less);
+  T kth = pbbs::kth_smallest(A, k - 1, less);
+  auto at_most = parlay::filter(A, [&] (T const &a) {return !less(kth, a);});
+  if (at_most.size() == k) return parlay::sort(at_most, less);
+  auto below = parlay::filter(at_most, [&] (T const &a) {return less(a, kth);});
+  auto equal = parlay::filter(at_most, [&] (T const &a) {return !less(a, kth);});
+  parlay::sort_inplace(below, less);
+  below.append(equal.begin(), equal.begin() + (k - below.size()));
+  return below;
+}
@@ -0,0 +1 @@
+../bench/wc.h
\ No newline at end of file
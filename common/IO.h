@@ -27,10 +27,19 @@
 #include <string>
 #include <string>
 #include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
 #include "../parlay/primitives.h"
 #include "../parlay/parallel.h"
 #include "../parlay/io.h"
 #include "../parlay/internal/get_time.h"
+#include "../algorithm/simd_level.h"
+#include "stringPool.h"
+
+#ifdef PBBS_SIMD_X86
+#include <immintrin.h>
+#endif
 
 namespace benchIO {
   using namespace std;
@@ -49,25 +58,129 @@ namespace benchIO {
     }
   };
 
+  // Character classes as bit masks, 64 bytes at a time (with AVX2 when
+  // the processor has it).  Bit i of a mask is set if s[i] is a word
+  // character, for i < len <= 64.  The classes are:
+  //   char_class::non_space : not is_space, as in the input file parsers
+  //   char_class::letter    : in [a-z] or [A-Z], as in the text benchmarks
+  enum class char_class {non_space, letter};
+
+  template <char_class C>
+  inline bool in_class(char c) {
+    if constexpr (C == char_class::non_space) return !is_space(c);
+    else return (c >= 65 && c < 91) || (c >= 97 && c < 123);
+  }
+
+#ifdef PBBS_SIMD_X86
+#pragma GCC push_options
+#pragma GCC target("avx2")
+  template <char_class C>
+  uint32_t class_mask_avx2(char const* s) {
+    __m256i v = _mm256_loadu_si256((__m256i const*) s);
+    if constexpr (C == char_class::non_space) {
+      __m256i sp = _mm256_or_si256(
+	  _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+			  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+	  _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')),
+					  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))),
+			  _mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+      return ~(uint32_t) _mm256_movemask_epi8(sp);
+    } else {
+      // setting bit 5 maps upper to lower case; bytes above 127 are
+      // negative so fail the signed compare with 'a'-1
+      __m256i l = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+      __m256i in = _mm256_and_si256(_mm256_cmpgt_epi8(l, _mm256_set1_epi8('a' - 1)),
+				    _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), l));
+      return (uint32_t) _mm256_movemask_epi8(in);
+    }
+  }
+#pragma GCC pop_options
+#endif
+
+  template <char_class C>
+  uint64_t class_mask(char const* s, size_t len) {
+#ifdef PBBS_SIMD_X86
+    if (len == 64 && pbbs::detected_simd_level() != pbbs::simd_level::none)
+      return ((uint64_t) class_mask_avx2<C>(s) |
+	      ((uint64_t) class_mask_avx2<C>(s + 32) << 32));
+#endif
+    uint64_t mask = 0;
+    for (size_t i = 0; i < len; i++)
+      mask |= (uint64_t) in_class<C>(s[i]) << i;
+    return mask;
+  }
+
+  // Start and end offsets of the words of s[0,n), i.e. the maximal runs of
+  // characters of class C.  Each block finds the starts (a word character
+  // after a non-word one) and ends of its words from the masks, one pass
+  // counts them per block, and a second writes them out.
+  template <char_class C>
+  sequence<pair<size_t,size_t>> word_offsets(char const* s, size_t n) {
+    constexpr size_t block_size = 1 << 14;
+    size_t num_blocks = (n + block_size - 1) / block_size;
+    // calls f(mask of word starts, mask of word ends, offset) for each 64
+    // bytes of block b, where an end bit marks the last character of a word
+    auto for_masks = [&] (size_t b, auto f) {
+      size_t end = min(n, (b+1) * block_size);
+      uint64_t prev = (b == 0) ? 0 : in_class<C>(s[b * block_size - 1]);
+      uint64_t mask = class_mask<C>(s + b * block_size, min<size_t>(64, end - b * block_size));
+      for (size_t i = b * block_size; i < end; i += 64) {
+	uint64_t next = (i + 64 < n) ? class_mask<C>(s + i + 64, min<size_t>(64, n - i - 64)) : 0;
+	f(mask & ~((mask << 1) | prev), mask & ~((mask >> 1) | (next << 63)), i);
+	prev = mask >> 63;
+	mask = next;
+      }
+    };
+    sequence<size_t> counts(num_blocks);
+    parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+      size_t c = 0;
+      for_masks(b, [&] (uint64_t starts, uint64_t, size_t) {
+	c += __builtin_popcountll(starts);});
+      counts[b] = c;
+    }, 1);
+    size_t m = parlay::scan_inplace(counts);
+    // the k-th end belongs to the k-th start, and a word that crosses into
+    // a block is the one before the block's first start
+    auto R = sequence<pair<size_t,size_t>>::uninitialized(m);
+    parlay::parallel_for(0, num_blocks, [&] (size_t b) {
+      size_t j = counts[b];
+      size_t k = (b > 0 && in_class<C>(s[b * block_size - 1]) &&
+		  in_class<C>(s[b * block_size])) ? j - 1 : j;
+      for_masks(b, [&] (uint64_t starts, uint64_t ends, size_t i) {
+	for (; starts != 0; starts &= starts - 1)
+	  R[j++].first = i + __builtin_ctzll(starts);
+	for (; ends != 0; ends &= ends - 1)
+	  R[k++].second = i + __builtin_ctzll(ends) + 1;});
+    }, 1);
+    return R;
+  }
+
+  // offsets of the words separated by is_space characters
+  template <class Seq>
+  sequence<pair<size_t,size_t>> word_offsets(Seq const &S) {
+    return word_offsets<char_class::non_space>(S.begin(), S.size());
+  }
+
+  // offsets of the words made of letters
+  template <class Seq>
+  sequence<pair<size_t,size_t>> letter_word_offsets(Seq const &S) {
+    return word_offsets<char_class::letter>(S.begin(), S.size());
+  }
+
   // parallel code for converting a string to word pointers
   // side effects string by setting to null after each word
   template <class Seq>
     parlay::sequence<char*> stringToWords(Seq &Str) {
     size_t n = Str.size();
+    auto W = word_offsets(Str);
     
-    parlay::parallel_for(0, n, [&] (long i) {
-	if (is_space(Str[i])) Str[i] = 0;}); 
-
-    // mark start of words
-    auto FL = parlay::tabulate(n, [&] (long i) -> bool {
-	return (i==0) ? Str[0] : Str[i] && !Str[i-1];});
-    
-    // offset for each start of word
-    auto Offsets = parlay::pack_index<long>(FL);
+    // null terminate each word
+    parlay::parallel_for(0, W.size(), [&] (long j) {
+	if (W[j].second < n) Str[W[j].second] = 0;});
 
     // pointer to each start of word
-    auto SA = parlay::tabulate(Offsets.size(), [&] (long j) -> char* {
-	return Str.begin() + Offsets[j];});
+    auto SA = parlay::tabulate(W.size(), [&] (long j) -> char* {
+	return Str.begin() + W[j].first;});
     
     return SA;
   }
@@ -79,6 +192,10 @@ namespace benchIO {
   inline void xToString(char* s, charstring const &a) {
     for (int i=0; i < a.size(); i++) s[i] = a[i];}
 
+  inline int xToStringLen(std::string_view a) { return a.size();}
+  inline void xToString(char* s, std::string_view a) {
+    for (size_t i=0; i < a.size(); i++) s[i] = a[i];}
+
   inline int xToStringLen(long a) { return 21;}
   inline void xToString(char* s, long a) { sprintf(s,"%ld",a);}
 
@@ -204,14 +321,35 @@ namespace benchIO {
     return writeSeqToFile(intHeaderIO, A, fileName);
   }
 
-  sequence<sequence<char>> get_tokens(char const *fileName) {
-    // parlay::internal::timer t("get_tokens");
-    // auto S = parlay::chars_from_file(fileName);
+  // the whitespace separated tokens of a file, packed into one buffer
+  string_pool get_tokens(char const *fileName) {
     auto S = parlay::file_map(fileName);
-    // t.next("file map");
-    auto r =  parlay::tokens(S, benchIO::is_space);
-    // t.next("tokens");
-    return r;
+    return string_pool(S.begin(), word_offsets(S));
+  }
+
+  inline long read_long(charstring const &S) {
+    return parlay::chars_to_long(S);}
+
+  inline double read_double(charstring const &S) {
+    return parlay::chars_to_double(S);}
+
+  inline long read_long(std::string_view S) {
+    size_t i = 0;
+    bool negative = (S.size() > 0 && S[0] == '-');
+    if (S.size() > 0 && (S[0] == '-' || S[0] == '+')) i++;
+    long r = 0;
+    for (; i < S.size(); i++) r = r * 10 + (S[i] - '0');
+    return negative ? -r : r;
+  }
+
+  inline double read_double(std::string_view S) {
+    char buf[64];
+    if (S.size() < sizeof(buf)) {
+      std::copy(S.begin(), S.end(), buf);
+      buf[S.size()] = 0;
+      return strtod(buf, nullptr);
+    }
+    return strtod(string(S).c_str(), nullptr);
   }
 
   template <class T>
@@ -224,7 +362,7 @@ namespace benchIO {
     }
     long n = W.size()-1;
     auto A = parlay::tabulate(n, [&] (long i) -> T {
-	return parlay::chars_to_long(W[i+1]);});
+	return read_long(W[i+1]);});
     return A;
   }
 };
@@ -198,17 +198,17 @@ namespace benchIO {
 
     // file consists of [type, num_vertices, num_edges, <vertex offsets>, <edges>]
     // in compressed sparse row format
-    long n = parlay::chars_to_long(W[1]);
-    long m = parlay::chars_to_long(W[2]);
+    long n = read_long(W[1]);
+    long m = read_long(W[2]);
     if (W.size() != n + m + 3) {
       cout << "Bad input file: length = "<< W.size() << " n+m+3 = " << n+m+3 << endl;
       abort(); }
     
     // tags on m at the end (so n+1 total offsets)
     auto offsets = parlay::tabulate(n+1, [&] (size_t i) -> intE {
-	return (i == n) ? m : parlay::chars_to_long(W[i+3]);});
+	return (i == n) ? m : read_long(W[i+3]);});
     auto edges = parlay::tabulate(m, [&] (size_t i) -> intV {
-	return parlay::chars_to_long(W[n+i+3]);});
+	return read_long(W[n+i+3]);});
 
     return graph<intV, intE>(std::move(offsets), std::move(edges), n);
   }
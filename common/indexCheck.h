@@ -0,0 +1,60 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// A sequential inverted index of the input of invertedIndex, indexQuery
+// and indexUpdate, for their checkers.  Documents start with doc_start
+// and are numbered from 0, and their words are the maximal runs of
+// letters, in lower case.  Each word maps to the sorted ids of the
+// documents it appears in.
+
+namespace benchIO {
+
+  inline std::map<std::string, std::vector<uint32_t>>
+  reference_index(std::string const &s, std::string const &doc_start = "<doc") {
+    std::vector<size_t> starts;
+    for (size_t i = s.find(doc_start); i != std::string::npos; i = s.find(doc_start, i + 1))
+      starts.push_back(i);
+    std::map<std::string, std::vector<uint32_t>> index;
+    for (size_t d = 0; d < starts.size(); d++) {
+      size_t end = (d + 1 == starts.size()) ? s.size() : starts[d+1];
+      std::string word;
+      for (size_t i = starts[d] + doc_start.size(); i <= end; i++) {
+	char c = (i < end) ? s[i] : 0;
+	if (c >= 'A' && c <= 'Z') word.push_back(c + 32);
+	else if (c >= 'a' && c <= 'z') word.push_back(c);
+	else if (word.size() > 0) {
+	  std::vector<uint32_t> &l = index[word];
+	  if (l.empty() || l.back() != d) l.push_back(d);
+	  word.clear();
+	}
+      }
+    }
+    return index;
+  }
+}
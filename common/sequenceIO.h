@@ -60,6 +60,7 @@ namespace benchIO {
   elementType dataType(double a) { return doubleT;}
   elementType dataType(charSeq a) { return stringT;}
   elementType dataType(char* a) { return stringT;}
+  elementType dataType(std::string_view a) { return stringT;}
   elementType dataType(intPair a) { return intPairT;}
   elementType dataType(uintPair a) { return intPairT;}
   elementType dataType(uintIntPair a) { return intPairT;}
@@ -102,12 +103,6 @@ namespace benchIO {
     else return none;
   }
 
-  long read_long(charSeq const &S) {
-    return chars_to_long(S);}
-
-  double read_double(charSeq const &S) {
-    return chars_to_double(S);}
-
   using charseq_slice = parlay::slice<const charSeq*, const charSeq*>;
   
 
@@ -150,6 +145,13 @@ namespace benchIO {
       return std::make_pair((uint) read_long(S[2*i]), (uint) read_long(S[2*i+1]));});
   }
 
+  template<typename T, typename Range>
+  inline typename std::enable_if<std::is_same<T, longPair>::value, sequence<longPair>>::type
+  parseElements(Range const &S) {
+    return tabulate((S.size())/2, [&] (long i) -> longPair {
+      return std::make_pair(read_long(S[2*i]), read_long(S[2*i+1]));});
+  }
+
   template<typename T, typename Range>
   inline typename std::enable_if<std::is_same<T, doublePair>::value, sequence<doublePair>>::type
   parseElements(Range const &S) {
@@ -160,7 +162,16 @@ namespace benchIO {
   template<typename T, typename Range>
   inline typename std::enable_if<std::is_same<T, charSeq>::value, sequence<charSeq>>::type
   parseElements(Range const &S) {
-    return parlay::to_sequence(S);
+    return tabulate(S.size(), [&] (long i) -> charSeq {
+      return parlay::to_sequence(S[i]);});
+  }
+
+  // views of the strings, valid while the pool S is
+  template<typename T, typename Range>
+  inline typename std::enable_if<std::is_same<T, std::string_view>::value,
+				 sequence<std::string_view>>::type
+  parseElements(Range const &S) {
+    return tabulate(S.size(), [&] (long i) -> std::string_view {return S[i];});
   }
 
   // sequence<stringIntPair> parseElements<stringIntPair>(Range S) {
@@ -168,9 +179,9 @@ namespace benchIO {
   // }  
 
   template <typename T, typename CharRange>
-  void check_header(CharRange& S) {
+  void check_header(CharRange const &S) {
     T a;
-    string header(S[0].begin(), S[0].end());
+    string header(S.begin(), S.end());
     string type_str = seqHeader(dataType(a));
     if (header != type_str) {
       cout << "bad header: expected " << type_str << " got " << header << endl;
@@ -0,0 +1,111 @@
+// This code is part of the Problem Based Benchmark Suite (PBBS)
+// Copyright (c) 2011 Guy Blelloch and the PBBS team
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <string_view>
+#include <utility>
+#include "../parlay/primitives.h"
+#include "../parlay/parallel.h"
+
+// A sequence of strings stored as one buffer of characters and an array
+// of offsets, instead of a sequence<sequence<char>> with an allocation
+// and a header per string.  Element i is a std::string_view of the
+// buffer, so the usual comparators and hashes (which only use data() and
+// size()) work on it unchanged.  The views are valid while the pool is.
+//
+//   string_pool P(S);        // packs a sequence of strings
+//   string_pool P(s, W);     // packs s[W[i].first, W[i].second) for each i
+//   P.size(), P[i]           // number of strings, and string i
+//   P.cut(i, j)              // non-owning view of strings [i, j)
+//   P.views()                // sequence of the string_views
+//   string_pool P(chars, offsets)  // takes over a buffer and its offsets
+
+namespace benchIO {
+
+  class string_pool_view {
+    char const* chars;
+    size_t const* offsets;
+    size_t n;
+  public:
+    using value_type = std::string_view;
+    string_pool_view(char const* chars, size_t const* offsets, size_t n)
+      : chars(chars), offsets(offsets), n(n) {}
+    size_t size() const {return n;}
+    std::string_view operator[](size_t i) const {
+      return std::string_view(chars + offsets[i], offsets[i+1] - offsets[i]);}
+    string_pool_view cut(size_t i, size_t j) const {
+      return string_pool_view(chars, offsets + i, j - i);}
+  };
+
+  class string_pool {
+    parlay::sequence<char> chars;
+    parlay::sequence<size_t> offsets;  // string i is chars[offsets[i], offsets[i+1])
+
+    // packs the n strings given by get(i), which returns a string_view
+    template <class Get>
+    void pack(size_t n, Get get) {
+      offsets = parlay::tabulate(n + 1, [&] (size_t i) -> size_t {
+	  return (i == n) ? 0 : get(i).size();});
+      size_t m = parlay::scan_inplace(offsets);
+      chars = parlay::sequence<char>::uninitialized(m);
+      parlay::parallel_for(0, n, [&] (size_t i) {
+	std::string_view s = get(i);
+	std::copy(s.begin(), s.end(), chars.begin() + offsets[i]);});
+    }
+
+  public:
+    using value_type = std::string_view;
+
+    string_pool() : offsets(1, (size_t) 0) {}
+
+    string_pool(parlay::sequence<char> chars, parlay::sequence<size_t> offsets)
+      : chars(std::move(chars)), offsets(std::move(offsets)) {}
+
+    template <class Strings>
+    explicit string_pool(Strings const &S) {
+      pack(S.size(), [&] (size_t i) {
+	  return std::string_view(S[i].data(), S[i].size());});
+    }
+
+    string_pool(char const* s, parlay::sequence<std::pair<size_t,size_t>> const &W) {
+      pack(W.size(), [&] (size_t i) {
+	  return std::string_view(s + W[i].first, W[i].second - W[i].first);});
+    }
+
+    size_t size() const {return offsets.size() - 1;}
+
+    std::string_view operator[](size_t i) const {
+      return std::string_view(chars.begin() + offsets[i], offsets[i+1] - offsets[i]);}
+
+    string_pool_view cut(size_t i, size_t j) const {
+      return string_pool_view(chars.begin(), offsets.begin() + i, j - i);}
+
+    // the underlying buffer and the n+1 offsets into it
+    char const* char_data() const {return chars.begin();}
+    size_t char_bytes() const {return chars.size();}
+    size_t const* offset_data() const {return offsets.begin();}
+
+    parlay::sequence<std::string_view> views() const {
+      return parlay::tabulate(size(), [&] (size_t i) {return (*this)[i];});}
+  };
+}